@@ -1,14 +1,172 @@
+#include <chrono>
+#include <csignal>
 #include <fstream>
+#include <iostream>
+#include <thread>
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
 #include "jira/jira_client.hpp"
+#include "jira/columns.hpp"
+#include "jira/snapshot.hpp"
+#include "jira/transport.hpp"
+#include "report/daemon.hpp"
+#include "report/report.hpp"
 
 using json = nlohmann::json;
 
 auto app_logger = spdlog::stdout_color_mt("Application");
 
+namespace {
+    volatile std::sig_atomic_t stop_signal = 0;
+
+    void requestStop(int) {
+        stop_signal = 1;
+    }
+
+    // Connect to Jira and apply optional settings of requests
+    std::unique_ptr<JiraClient> connect(const json& params, std::shared_ptr<Transport> transport, std::shared_ptr<Executor> executor) {
+        std::unique_ptr<JiraClient> client(new JiraClient(params.at("jira_url"), transport));
+        client->setExecutor(executor);
+        client->setConcurrency(params.value("concurrency", 4));
+        if (params.contains("rate_limit")) {
+            SchedulerOptions rate_limit;
+            rate_limit.requests_per_second = params.at("rate_limit").value("requests_per_second", rate_limit.requests_per_second);
+            rate_limit.burst = params.at("rate_limit").value("burst", rate_limit.burst);
+            rate_limit.max_retries = params.at("rate_limit").value("max_retries", rate_limit.max_retries);
+            client->setRateLimit(rate_limit);
+        }
+        // Optional projection of issue fields, filtering by tracked people is set by the caller
+        if (params.contains("issue_query")) {
+            IssueQuery query;
+            query.fields = params.at("issue_query").value("fields", query.fields);
+            query.expand = params.at("issue_query").value("expand", query.expand);
+            query.comment_clause = params.at("issue_query").value("comment_clause", query.comment_clause);
+            client->setIssueQuery(query);
+        }
+        if (params.contains("cache_dir")) {
+            client->setCacheDirectory(params.at("cache_dir"));
+        }
+        if (params.contains("user_ttl_hours")) {
+            client->setUserTtl(params.at("user_ttl_hours").get<double>() * 3600);
+        }
+        return client;
+    }
+
+    // Map the snapshot of closed sprints if there is one, a damaged file is replaced at the end of the run
+    std::unique_ptr<SnapshotView> openSnapshot(const std::string& path) {
+        if (!std::ifstream(path).good()) {
+            return nullptr;
+        }
+        try {
+            return std::unique_ptr<SnapshotView>(new SnapshotView(path));
+        } catch (const std::runtime_error& error) {
+            app_logger->warn("Snapshot {} is ignored: {}", path, error.what());
+            return nullptr;
+        }
+    }
+
+    // Position of a closed sprint in the snapshot, -1 if the sprint must be requested
+    int snapshotSprint(const SnapshotView* snapshot, const JiraSprint& sprint) {
+        if (snapshot == nullptr || !sprint.is_closed) {
+            return -1;
+        }
+        return snapshot->findSprint(sprint.id);
+    }
+
+    // Sprints of the board with issues, closed sprints of the snapshot are created from it without requests
+    std::vector<JiraSprint*> fetchSprints(JiraClient& client, const json& period, const std::string& board,
+        const SnapshotView* snapshot, JiraArena& arena) {
+        std::vector<JiraSprint*> sprints;
+        if (period.at("type") == "names") {
+            sprints = client.findSprints(board, period.at("sprint_names").get<std::set<std::string>>());
+        } else if (period.at("type") == "dates") {
+            // get all sprints between two dates
+            sprints = client.findSprints(board, period.at("start_date"), period.at("end_date"));
+        } else {
+            throw std::invalid_argument("Incorrect period type provided. Can be 'names' or 'dates'.");
+        }
+        std::vector<JiraSprint*> requested;
+        for (auto& sprint : sprints) {
+            int index = snapshotSprint(snapshot, *sprint);
+            if (index >= 0) {
+                sprint = snapshot->toSprint(index, &arena);
+            } else {
+                requested.push_back(sprint);
+            }
+        }
+        client.loadIssues(requested);
+        return sprints;
+    }
+
+    // Add closed sprints of this run to the snapshot, sprints of other periods are kept
+    void saveSnapshot(const std::string& path, const SnapshotView* snapshot, const std::vector<std::vector<JiraSprint*>>& board_sprints) {
+        SnapshotWriter writer;
+        std::set<int> added;
+        bool changed = snapshot == nullptr;
+        for (const auto& sprints : board_sprints) {
+            for (auto sprint : sprints) {
+                if (sprint->is_closed && added.insert(sprint->id).second) {
+                    changed = changed || snapshotSprint(snapshot, *sprint) < 0;
+                    writer.add(*sprint);
+                }
+            }
+        }
+        if (!changed) {
+            return;
+        }
+        JiraArena arena;
+        for (size_t i = 0; snapshot != nullptr && i < snapshot->sprintCount(); i++) {
+            if (added.insert(snapshot->sprint(i).id).second) {
+                writer.add(*snapshot->toSprint(i, &arena));
+            }
+        }
+        writer.save(path);
+        app_logger->info("Snapshot of {} closed sprints is saved into {}", added.size(), path);
+    }
+
+    // Keep results in memory and answer report requests until SIGINT or SIGTERM
+    int runDaemon(const json& params, std::shared_ptr<Transport> transport, std::shared_ptr<Executor> executor,
+        const std::vector<std::string>& boards, bool filter_people) {
+        const json& daemon_params = params.at("daemon");
+        DaemonOptions options;
+        options.boards = boards;
+        options.people = params.at("names").get<std::vector<std::string>>();
+        options.filter_people = filter_people;
+        if (params.at("period").at("type") == "names") {
+            options.sprint_names = params.at("period").at("sprint_names").get<std::set<std::string>>();
+        } else if (params.at("period").at("type") == "dates") {
+            options.start_date = params.at("period").at("start_date");
+            options.end_date = params.at("period").at("end_date");
+        } else {
+            throw std::invalid_argument("Incorrect period type provided. Can be 'names' or 'dates'.");
+        }
+        options.refresh_seconds = daemon_params.value("refresh_seconds", options.refresh_seconds);
+        options.recycle_after = daemon_params.value("recycle_after", options.recycle_after);
+        ReportDaemon daemon([&params, transport, executor]() {
+            return connect(params, transport, executor);
+        }, options);
+        // the first refresh is done before the endpoint is opened, so it never serves empty reports
+        daemon.refresh();
+        daemon.start();
+        LocalHttpServer server([&daemon](const HttpRequest& request) {
+            return daemon.handle(request);
+        }, daemon_params.value("port", 8080), daemon_params.value("address", std::string("127.0.0.1")));
+        app_logger->info("Reports are served on {}/report, refresh every {} seconds", server.url(), options.refresh_seconds);
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
+        while (!stop_signal) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+        app_logger->info("Stopping...");
+        server.stop();
+        daemon.stop();
+        spdlog::shutdown();
+        return 0;
+    }
+}
+
 int main() {
     app_logger->set_pattern("[Application] [%^%l%$] %v");
     app_logger->set_level(spdlog::level::info);
@@ -16,103 +174,129 @@ int main() {
     std::ifstream params_file {"params.json"};
     json params = json::parse(params_file);
 
+    // Optional settings for pooled connections
+    SessionOptions connection;
+    if (params.contains("connection")) {
+        connection.compression = params.at("connection").value("compression", connection.compression);
+        connection.http2 = params.at("connection").value("http2", connection.http2);
+    }
+
     // Connect to Jira Cleint using username:token for auth
-    JiraClient *client = new JiraClient(
-        params.at("jira_url"), 
-        params.at("username"), 
-        params.at("token"));
+    std::shared_ptr<Transport> transport = std::make_shared<CprTransport>(params.at("username"), params.at("token"), connection);
+    // Optional recording of responses or an offline run on recorded ones
+    if (params.contains("replay")) {
+        bool record = params.at("replay").value("mode", std::string("replay")) == "record";
+        transport = std::make_shared<ReplayTransport>(
+            params.at("replay").at("directory"),
+            record ? ReplayTransport::Mode::Record : ReplayTransport::Mode::Replay,
+            transport);
+    }
+    // one pool of threads for requests, parsing and counting of all boards
+    auto executor = std::make_shared<Executor>(params.value("threads", 8));
+    bool filter_people = params.contains("issue_query") && params.at("issue_query").value("filter_people", false);
+    // a list of boards or a single one
+    std::vector<std::string> boards;
+    if (params.contains("boards")) {
+        boards = params.at("boards").get<std::vector<std::string>>();
+    } else {
+        boards.push_back(params.at("board_with_sprints"));
+    }
+    if (params.contains("daemon")) {
+        return runDaemon(params, transport, executor, boards, filter_people);
+    }
+    std::unique_ptr<JiraClient> client = connect(params, transport, executor);
     
     // =========================================
     // Get data from Jira API
     // =========================================
     
-    // get users for each entity in json->names array
+    // users and sprints are requested at the same time, unless sprint issues are filtered by users
+    std::future<std::vector<JiraUser*>> person_lookup = client->getPersonsAsync(params.at("names").get<std::vector<std::string>>());
     std::vector<JiraUser*> persons;
-    for(auto name = params.at("names").begin(); name != params.at("names").end(); ++name) {
-        persons.push_back(client->getPerson(*name));
-    }
-    std::vector<JiraSprint*> sprints;
-    if (params.at("period").at("type") == "names") {
-        sprints = client->getSprints(
-            params.at("board_with_sprints"),
-            params.at("period").at("sprint_names")
-        );
-    } else if (params.at("period").at("type") == "dates") {
-        // get all sprints between two dates
-        sprints = client->getSprints(
-            params.at("board_with_sprints"),
-            params.at("period").at("start_date"),
-            params.at("period").at("end_date")
-        );
-    } else {
-        throw std::invalid_argument("Incorrect period type provided. Can be 'names' or 'dates'.");
-    }
-    // count results for each person in each sprint
-    std::map<JiraSprint*, std::map<JiraUser*, PersonalResult*>> results;
-    for(auto sprint : sprints) {
-        std::map<JiraUser*, PersonalResult*> sprint_results;
-        for(auto person : persons) {
-            sprint_results.insert({person, client->getPersonResults(*person, *sprint)});
-        }
-        results.insert({sprint, sprint_results});
+    if (filter_people) {
+        executor->wait(person_lookup);
+        persons = person_lookup.get();
+        client->setTrackedPeople(persons);
+    }
+    // Optional snapshot of closed sprints, they are read from the mapped file instead of Jira
+    std::unique_ptr<SnapshotView> snapshot;
+    JiraArena snapshot_arena;
+    if (params.contains("snapshot")) {
+        snapshot = openSnapshot(params.at("snapshot"));
+    }
+    // all boards are fetched at the same time, a big board doesn't hold the small ones
+    std::vector<std::future<std::vector<JiraSprint*>>> sprint_fetches;
+    for(const auto& board : boards) {
+        sprint_fetches.push_back(executor->submit([&, board]() {
+            return fetchSprints(*client, params.at("period"), board, snapshot.get(), snapshot_arena);
+        }));
+    }
+    if (person_lookup.valid()) {
+        executor->wait(person_lookup);
+        persons = person_lookup.get();
     }
-    app_logger->info("Finished counting results!");
 
-    
     //======================================
-    // Print results
+    // Count and report results
     //======================================
-    for(auto sprint_results : results) {
-        app_logger->info("=========================================================");
-        app_logger->info("Results for sprint: {}", sprint_results.first->name);
-        app_logger->info("=========================================================");
-        for(auto person_result : sprint_results.second) {
-            app_logger->info("{} results: ", person_result.first->name);
-            int subtasks_count = 0;
-            int bugs_count = 0;
-            int issues_count = 0;
-            int other_count = 0;
-            int comment_chars = 0;
-            int story_points_finished = 0;
-            for(auto issue : person_result.second->finished) {
-                switch (issue->type) {
-                case IssueType::Subtask:
-                    subtasks_count ++;
-                    story_points_finished += issue->story_points;
-                    break;
-                case IssueType::Task:
-                case IssueType::Enabler:
-                case IssueType::Debt:
-                     issues_count ++;
-                     story_points_finished += issue->story_points;
-                     break;
-                case IssueType::Bug:
-                    bugs_count ++;
-                    story_points_finished += issue->story_points;
-                    break;
-                case IssueType::Story:
-                    issues_count++;
-                    break;
-                default:
-                    app_logger->info("Not sure how to count {} - {}", issue->key, issue->title);
-                    other_count ++;
-                    break;
-                }
-         
-            }
-            for (auto comment : person_result.second->comments_written) {
-                comment_chars += comment.text.length();
+    // Markdown into the console unless a report file is configured
+    ReportFormat report_format = ReportFormat::Markdown;
+    std::ofstream report_file;
+    if (params.contains("report")) {
+        report_format = ReportWriter::formatFromName(params.at("report").value("format", std::string("markdown")));
+        if (params.at("report").contains("file")) {
+            report_file.open(params.at("report").at("file").get<std::string>());
+            if (!report_file.is_open()) {
+                throw std::runtime_error("Cannot open report file: " + params.at("report").at("file").get<std::string>());
             }
-            app_logger->info("__Finished subtasks: {}", subtasks_count);
-            app_logger->info("__Finished issues: {}", issues_count);
-            app_logger->info("__Finished bugs: {}", bugs_count);
-            app_logger->info("__Finished others: {}", other_count);
-            app_logger->info("__Story Points: {}", story_points_finished);
-            app_logger->info("__Comments written: {}", person_result.second->comments_written.size());
-            app_logger->info("__Comments lines: {} lines with {} total characters", comment_chars/125, comment_chars);
-            app_logger->info("-----------------------------------------------------");
         }
     }
+    std::unique_ptr<ReportWriter> report = ReportWriter::create(report_format, report_file.is_open() ? report_file : std::cout);
+    std::vector<AccountHandle> handles;
+    for(auto person : persons) {
+        handles.push_back(person->handle);
+    }
+    // each board is counted and written out as soon as its sprints are fetched
+    std::vector<std::future<void>> board_reports;
+    std::vector<std::vector<JiraSprint*>> board_sprints(sprint_fetches.size());
+    for(size_t board = 0; board < sprint_fetches.size(); board++) {
+        board_reports.push_back(executor->submit([&, board]() {
+            executor->wait(sprint_fetches[board]);
+            board_sprints[board] = sprint_fetches[board].get();
+            for(auto sprint : board_sprints[board]) {
+                std::vector<PersonalResult*> results = client->getSprintResults(persons, *sprint);
+                // columns of snapshot sprints are read in place
+                int index = snapshotSprint(snapshot.get(), *sprint);
+                SprintColumns columns = index >= 0 ? snapshot->columns(index) : SprintColumns::fromSprint(*sprint);
+                std::vector<PersonTally> tallies = columns.countFinished(handles, sprint->end_date);
+                for(auto result : results) {
+                    for(auto issue : result->finished) {
+                        if (SprintColumns::categorize(issue->type) == CountedOther) {
+                            app_logger->info("Not sure how to count {} - {}", issue->key, issue->title);
+                        }
+                    }
+                }
+                report->writeSprint(*sprint, persons, results, tallies);
+            }
+        }));
+    }
+    for(auto& board_report : board_reports) {
+        executor->wait(board_report);
+        board_report.get();
+    }
+    report->finish();
+    if (params.contains("snapshot")) {
+        saveSnapshot(params.at("snapshot"), snapshot.get(), board_sprints);
+    }
+    app_logger->info("Finished counting results! {} rows reported", report->rows());
+    SchedulerStats request_stats = client->requestStats();
+    app_logger->info("Requests: {} sent, {} throttled, {} retried, {} failed", request_stats.requests, request_stats.throttled, request_stats.retried, request_stats.failed);
+    if (params.contains("metrics_file")) {
+        client->getMetrics().save(params.at("metrics_file"));
+        app_logger->info("Metrics are saved into {}", params.at("metrics_file").get<std::string>());
+    }
 
+    // write out messages still queued by the asynchronous loggers of the library
+    spdlog::shutdown();
     return 0;
 }
\ No newline at end of file
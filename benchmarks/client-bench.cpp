@@ -0,0 +1,173 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <map>
+#include <memory>
+
+#include "fixtures.hpp"
+#include "jira/aggregator.hpp"
+#include "jira/arena.hpp"
+#include "jira/columns.hpp"
+#include "jira/executor.hpp"
+#include "jira/pagination.hpp"
+#include "jira/snapshot.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    const size_t COMMENTS = 8;      // comments in each generated issue
+    const size_t TRACKED = 5;       // tracked people, out of fixtures::ACCOUNTS
+
+    const std::vector<std::string>& cachedPages(size_t total) {
+        static std::map<size_t, std::vector<std::string>> pages;
+        auto found = pages.find(total);
+        if (found == pages.end()) {
+            found = pages.insert({total, fixtures::issuePages(total, COMMENTS)}).first;
+        }
+        return found->second;
+    }
+
+    // Sprint with parsed issues, built once for each size
+    JiraSprint& cachedSprint(size_t total) {
+        static JiraArena arena;
+        static std::map<size_t, JiraSprint*> sprints;
+        auto found = sprints.find(total);
+        if (found == sprints.end()) {
+            JiraSprint* sprint = arena.sprints.create();
+            *sprint = fixtures::sprint();
+            for (const auto& page : cachedPages(total)) {
+                json parsed = json::parse(page);
+                for (const auto& issue : parsed.at("issues")) {
+                    sprint->issues.push_back(JiraIssue::fromJSON(issue, &arena));
+                }
+            }
+            found = sprints.insert({total, sprint}).first;
+        }
+        return *found->second;
+    }
+
+    std::vector<JiraUser*> pointers(std::vector<JiraUser>& people) {
+        std::vector<JiraUser*> result;
+        for (auto& person : people) {
+            result.push_back(&person);
+        }
+        return result;
+    }
+}
+
+static void BM_IssueFromJSON(benchmark::State& state, CommentMode mode) {
+    json issues = fixtures::generateIssues(fixtures::PAGE_SIZE, state.range(0));
+    ParseOptions options;
+    options.comments = mode;
+    for (auto _ : state) {
+        JiraArena arena;
+        for (const auto& issue : issues) {
+            benchmark::DoNotOptimize(JiraIssue::fromJSON(issue, &arena, options));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * issues.size());
+}
+BENCHMARK_CAPTURE(BM_IssueFromJSON, compact, CommentMode::Compact)->Arg(0)->Arg(8)->Arg(32);
+BENCHMARK_CAPTURE(BM_IssueFromJSON, full, CommentMode::Full)->Arg(0)->Arg(8)->Arg(32);
+
+static void BM_PageParse(benchmark::State& state) {
+    const std::string& page = cachedPages(fixtures::PAGE_SIZE).front();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(json::parse(page));
+    }
+    state.SetBytesProcessed(state.iterations() * page.size());
+}
+BENCHMARK(BM_PageParse);
+
+// Page body -> issues, the argument is the number of executor threads (0 maps on the calling thread)
+static void BM_IssuePage(benchmark::State& state, JsonParser parser) {
+    const std::string& page = cachedPages(fixtures::PAGE_SIZE).front();
+    ParseOptions options;
+    options.parser = parser;
+    std::unique_ptr<Executor> executor(state.range(0) > 0 ? new Executor(state.range(0)) : nullptr);
+    for (auto _ : state) {
+        JiraArena arena;
+        std::vector<JiraIssue*> issues;
+        benchmark::DoNotOptimize(JiraIssue::fromPage(page, "issues", issues, &arena, options, executor.get()));
+    }
+    state.SetBytesProcessed(state.iterations() * page.size());
+    state.SetLabel(parser == JsonParser::Simdjson && JiraIssue::simdjsonAvailable() ? "simdjson" : "nlohmann");
+}
+BENCHMARK_CAPTURE(BM_IssuePage, nlohmann, JsonParser::Nlohmann)->Arg(0)->Arg(4)->UseRealTime();
+BENCHMARK_CAPTURE(BM_IssuePage, simdjson, JsonParser::Simdjson)->Arg(0)->Arg(4)->UseRealTime();
+
+// What JiraClient::getSprintResults (and getPersonResults) do after issues are loaded
+static void BM_SprintResults(benchmark::State& state) {
+    const JiraSprint& sprint = cachedSprint(state.range(0));
+    std::vector<JiraUser> people = fixtures::people(TRACKED);
+    std::vector<JiraUser*> persons = pointers(people);
+    for (auto _ : state) {
+        JiraArena arena;
+        benchmark::DoNotOptimize(SprintAggregator(persons).aggregate(sprint, &arena));
+    }
+    state.SetItemsProcessed(state.iterations() * sprint.issues.size());
+}
+BENCHMARK(BM_SprintResults)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_CountFinished(benchmark::State& state) {
+    const JiraSprint& sprint = cachedSprint(state.range(0));
+    std::vector<AccountHandle> handles;
+    for (const auto& person : fixtures::people(TRACKED)) {
+        handles.push_back(person.handle);
+    }
+    SprintColumns columns = SprintColumns::fromSprint(sprint);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(columns.countFinished(handles, sprint.end_date));
+    }
+    state.SetItemsProcessed(state.iterations() * sprint.issues.size());
+}
+BENCHMARK(BM_CountFinished)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// The counter app without network: pages -> JSON -> objects -> results and tallies
+static void BM_Pipeline(benchmark::State& state) {
+    const size_t total = state.range(0);
+    const std::vector<std::string>& pages = cachedPages(total);
+    std::vector<JiraUser> people = fixtures::people(TRACKED);
+    std::vector<JiraUser*> persons = pointers(people);
+    std::vector<AccountHandle> handles;
+    for (const auto& person : people) {
+        handles.push_back(person.handle);
+    }
+    const JiraSprint metadata = fixtures::sprint();
+    for (auto _ : state) {
+        JiraArena arena;
+        JiraSprint* sprint = arena.sprints.create();
+        *sprint = metadata;
+        PageIterator iterator([&pages](int start_at) {
+            return pages[start_at / fixtures::PAGE_SIZE];
+        }, "issues");
+        while (iterator.next()) {
+            for (const auto& issue : iterator.items()) {
+                sprint->issues.push_back(JiraIssue::fromJSON(issue, &arena));
+            }
+        }
+        benchmark::DoNotOptimize(SprintAggregator(persons).aggregate(*sprint, &arena));
+        benchmark::DoNotOptimize(SprintColumns::fromSprint(*sprint).countFinished(handles, sprint->end_date));
+    }
+    state.SetItemsProcessed(state.iterations() * total);
+}
+BENCHMARK(BM_Pipeline)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// Historical sprint from a snapshot: mmap -> columns -> tallies, compare with BM_Pipeline
+static void BM_SnapshotCount(benchmark::State& state) {
+    const JiraSprint& sprint = cachedSprint(state.range(0));
+    std::string path = "client-bench-" + std::to_string(state.range(0)) + ".snapshot";
+    SnapshotWriter writer;
+    writer.add(sprint);
+    writer.save(path);
+    std::vector<AccountHandle> handles;
+    for (const auto& person : fixtures::people(TRACKED)) {
+        handles.push_back(person.handle);
+    }
+    for (auto _ : state) {
+        SnapshotView view(path);
+        benchmark::DoNotOptimize(view.columns(0).countFinished(handles, view.sprint(0).end_date));
+    }
+    state.SetItemsProcessed(state.iterations() * sprint.issues.size());
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_SnapshotCount)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
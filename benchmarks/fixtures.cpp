@@ -0,0 +1,95 @@
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#include "fixtures.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    std::string account(size_t number) {
+        std::string suffix = std::to_string(number);
+        return "5e9d6a0c1b2a3c0c8a7f" + std::string(4 - suffix.size(), '0') + suffix;
+    }
+
+    // a day inside "SW Sprint 17" (2020-05-27 - 2020-06-10)
+    std::string sprintDay(size_t day) {
+        return "2020-06-0" + std::to_string(1 + day % 9) + "T10:15:00.000+0000";
+    }
+}
+
+namespace fixtures {
+    json load(const std::string& name) {
+        std::ifstream file(std::string(JIRA_FIXTURES_DIR) + "/" + name + ".json");
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open fixture " + name);
+        }
+        return json::parse(file);
+    }
+
+    json generateIssues(size_t count, size_t comments, size_t first) {
+        static const json templates = load("issue").at("issues");
+        json comment_templates = json::array();
+        for (const auto& issue : templates) {
+            for (const auto& comment : issue.at("fields").at("comment").at("comments")) {
+                comment_templates.push_back(comment);
+            }
+        }
+        json issues = json::array();
+        for (size_t i = first; i < first + count; i++) {
+            json issue = templates[i % templates.size()];
+            issue["id"] = std::to_string(100000 + i);
+            issue["key"] = "MPA1-" + std::to_string(i + 1);
+            json& fields = issue["fields"];
+            if (!fields.at("assignee").is_null()) {
+                fields["assignee"] = {{"accountId", account(i % ACCOUNTS)}};
+            }
+            if (!fields.at("resolution").is_null()) {
+                // every tenth issue is resolved after the end of the sprint
+                fields["resolutiondate"] = i % 10 == 0 ? "2020-06-15T12:00:00.000+0000" : sprintDay(i);
+            }
+            json& issue_comments = fields["comment"]["comments"];
+            issue_comments = json::array();
+            for (size_t j = 0; j < comments; j++) {
+                json comment = comment_templates[(i + j) % comment_templates.size()];
+                comment["id"] = std::to_string(1000000 + i * comments + j);
+                comment["author"] = {{"accountId", account((i + j + 1) % ACCOUNTS)}};
+                comment["created"] = sprintDay(i + j);
+                issue_comments.push_back(std::move(comment));
+            }
+            fields["comment"]["total"] = comments;
+            issues.push_back(std::move(issue));
+        }
+        return issues;
+    }
+
+    std::vector<std::string> issuePages(size_t total, size_t comments) {
+        std::vector<std::string> pages;
+        for (size_t start_at = 0; start_at < total; start_at += PAGE_SIZE) {
+            size_t count = std::min(PAGE_SIZE, total - start_at);
+            json page = {
+                {"startAt", start_at},
+                {"maxResults", PAGE_SIZE},
+                {"total", total},
+                {"issues", generateIssues(count, comments, start_at)}};
+            pages.push_back(page.dump());
+        }
+        return pages;
+    }
+
+    JiraSprint sprint() {
+        static const json recorded = load("sprint").at("values").at(1);
+        std::unique_ptr<JiraSprint> sprint(JiraSprint::fromJSON(recorded));
+        return *sprint;
+    }
+
+    std::vector<JiraUser> people(size_t count) {
+        std::vector<JiraUser> people(std::min(count, ACCOUNTS));
+        for (size_t i = 0; i < people.size(); i++) {
+            people[i].id = account(i);
+            people[i].name = "Person " + std::to_string(i);
+            people[i].handle = AccountIndex::intern(people[i].id);
+        }
+        return people;
+    }
+}
@@ -0,0 +1,71 @@
+/**
+ * @file fixtures.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Recorded Jira payloads and generator of large sprints for benchmarks
+ * @version 0.1
+ * @date 2020-07-04
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef FIXTURES_H_
+#define FIXTURES_H_
+
+#include <jira/types.hpp>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace fixtures {
+    const size_t PAGE_SIZE = 200;       // issues per page, as MAX_ISSUES_IN_REQUEST
+    const size_t ACCOUNTS = 20;         // accounts which own generated issues and comments
+
+    /**
+     * @brief Load a recorded payload from benchmarks/fixtures
+     *
+     * @param [in] name "board", "sprint" or "issue"
+     * @return nlohmann::json parsed payload
+     */
+    nlohmann::json load(const std::string& name);
+
+    /**
+     * @brief Generate issues by copying the recorded ones
+     *
+     * Ids, keys, assignees, comment authors and dates are changed, so issues are
+     * spread over ACCOUNTS accounts and most of them are resolved inside the sprint.
+     * The result is deterministic.
+     *
+     * @param [in] count number of issues
+     * @param [in] comments comments in each issue
+     * @param [in] first number of the first issue
+     * @return nlohmann::json array of issues
+     */
+    nlohmann::json generateIssues(size_t count, size_t comments, size_t first = 0);
+
+    /**
+     * @brief Generate bodies of all pages of the sprint issues endpoint
+     *
+     * @param [in] total number of issues in the sprint
+     * @param [in] comments comments in each issue
+     * @return std::vector<std::string> pages of PAGE_SIZE issues
+     */
+    std::vector<std::string> issuePages(size_t total, size_t comments);
+
+    /**
+     * @brief Get the recorded sprint the generated issues belong to
+     *
+     * @return JiraSprint sprint without issues
+     */
+    JiraSprint sprint();
+
+    /**
+     * @brief Get people who own generated issues
+     *
+     * @param [in] count number of people, at most ACCOUNTS
+     * @return std::vector<JiraUser> people with interned accounts
+     */
+    std::vector<JiraUser> people(size_t count);
+}
+
+#endif // FIXTURES_H_
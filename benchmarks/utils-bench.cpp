@@ -0,0 +1,56 @@
+#include <benchmark/benchmark.h>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "utils.hpp"
+
+namespace {
+    // Previous implementation, kept here as a reference point for the new parser
+    time_t legacyParseTimestamp(const std::string timestamp) {
+        std::tm date = {};
+        std::stringstream ss {timestamp};
+        ss >> std::get_time(&date, "%Y-%m-%dT%H:%M:%S");
+        return mktime(&date);
+    }
+
+    std::string legacyTimeToString(const time_t time) {
+        char buffer[26];
+        std::tm* date = localtime(&time);
+        strftime(buffer, 26, "%Y-%m-%d %H:%M:%S", date);
+        return std::string(buffer);
+    }
+
+    const std::string JIRA_TIMESTAMP = "2020-05-27T13:45:12.345+0300";
+}
+
+static void BM_ParseTimestampLegacy(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(legacyParseTimestamp(JIRA_TIMESTAMP));
+    }
+}
+BENCHMARK(BM_ParseTimestampLegacy);
+
+static void BM_ParseTimestamp(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Utils::parseTimestapm(JIRA_TIMESTAMP));
+    }
+}
+BENCHMARK(BM_ParseTimestamp);
+
+static void BM_TimeToStringLegacy(benchmark::State& state) {
+    time_t time = Utils::parseTimestapm(JIRA_TIMESTAMP);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(legacyTimeToString(time));
+    }
+}
+BENCHMARK(BM_TimeToStringLegacy);
+
+static void BM_TimeToString(benchmark::State& state) {
+    time_t time = Utils::parseTimestapm(JIRA_TIMESTAMP);
+    char buffer[26];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Utils::timeToString(time, buffer, sizeof(buffer)));
+    }
+}
+BENCHMARK(BM_TimeToString);
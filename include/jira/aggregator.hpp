@@ -0,0 +1,53 @@
+/**
+ * @file aggregator.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Counting of personal results for many people at once
+ * @version 0.1
+ * @date 2020-06-18
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef AGGREGATOR_H_
+#define AGGREGATOR_H_
+
+#include <jira/types.hpp>
+#include <jira/arena.hpp>
+#include <vector>
+
+/**
+ * @brief Counts results of all tracked people in a single pass over a sprint
+ *
+ * Every issue and every comment of the sprint is visited once and dispatched
+ * to its owner through a table indexed by account handle, so the cost does not
+ * grow with the number of tracked people.
+ */
+class SprintAggregator {
+    public:
+        /**
+         * @brief Construct a new Sprint Aggregator object
+         *
+         * @param [in] people list of people whose results will be counted, may contain duplicates
+         */
+        SprintAggregator(const std::vector<JiraUser*>& people);
+
+        /**
+         * @brief Count results of all people in the sprint
+         *
+         * @param [in] sprint sprint with already loaded issues
+         * @param [in] arena owner of created results, if nullptr the caller owns them
+         * @return std::vector<PersonalResult*> results in the same order as people were provided, a person
+         * listed twice gets two equal results
+         */
+        std::vector<PersonalResult*> aggregate(const JiraSprint& sprint, JiraArena* arena = nullptr) const;
+
+    private:
+        int position(AccountHandle handle) const;
+
+        std::vector<const JiraUser*> people;   /** < distinct people */
+        std::vector<int> index;     /** < account handle -> position in people, -1 if not tracked */
+        std::vector<int> slots;     /** < position in the constructor's list -> position in people */
+};
+
+#endif // AGGREGATOR_H_
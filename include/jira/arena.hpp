@@ -0,0 +1,70 @@
+/**
+ * @file arena.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Storage which owns all objects created during one session with Jira
+ * @version 0.1
+ * @date 2020-06-25
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <jira/types.hpp>
+#include <deque>
+#include <mutex>
+
+/**
+ * @brief Thread-safe pool of objects of one type
+ *
+ * Objects are kept in large contiguous blocks and never move, so returned
+ * pointers stay valid until the pool is destroyed. All objects are destroyed
+ * together with the pool.
+ *
+ * @tparam T type of stored objects, must be default constructible
+ */
+template <class T>
+class ObjectPool {
+    public:
+        /**
+         * @brief Create a new default constructed object inside the pool
+         *
+         * @return T* pointer to the object, owned by the pool
+         */
+        T* create() {
+            std::lock_guard<std::mutex> guard(mutex);
+            items.emplace_back();
+            return &items.back();
+        }
+
+        /**
+         * @brief Get number of objects in the pool
+         *
+         * @return size_t number of created objects
+         */
+        size_t size() const {
+            std::lock_guard<std::mutex> guard(mutex);
+            return items.size();
+        }
+
+    private:
+        std::deque<T> items;
+        mutable std::mutex mutex;
+};
+
+/**
+ * @brief Owner of all users, sprints, issues and results of one session
+ *
+ * Memory is freed as a unit when the arena is destroyed.
+ */
+class JiraArena {
+    public:
+        ObjectPool<JiraUser> users;             /** < Users found in Jira */
+        ObjectPool<JiraSprint> sprints;         /** < Sprints with their metadata */
+        ObjectPool<JiraIssue> issues;           /** < Issues of all sprints */
+        ObjectPool<PersonalResult> results;     /** < Counted personal results */
+};
+
+#endif // ARENA_H_
@@ -0,0 +1,133 @@
+/**
+ * @file board_index.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Index of Jira boards and their sprints
+ * @version 0.1
+ * @date 2020-06-29
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef BOARD_INDEX_H_
+#define BOARD_INDEX_H_
+
+#include <jira/types.hpp>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Metadata of boards and sprints shared by all requests of a session
+ *
+ * Keeps board name -> id and board id -> sprints (without issues) sorted by start
+ * date. Sprints can be selected by names or by date interval without requests
+ * to Jira. The index can be saved to a file and loaded in the next session, then
+ * sprint lists are marked as not fresh and have to be refreshed by the client.
+ * All methods are thread-safe.
+ */
+class BoardIndex {
+    public:
+        /**
+         * @brief Get ID of the board by its name
+         *
+         * @param [in] board_name name of the board
+         * @return int ID of the board, -1 if the board is unknown
+         */
+        int boardId(const std::string& board_name) const;
+
+        /**
+         * @brief Replace the list of known boards
+         *
+         * @param [in] boards board name -> board id
+         */
+        void setBoards(const std::map<std::string, int>& boards);
+
+        /**
+         * @brief Check that sprints of the board were loaded from Jira during this session
+         *
+         * @param [in] board_id ID of the board
+         * @return true if the sprint list of the board is up to date
+         */
+        bool isFresh(int board_id) const;
+
+        /**
+         * @brief Get all known sprints of the board
+         *
+         * @param [in] board_id ID of the board
+         * @return std::vector<JiraSprint> sprints sorted by start date, issues are not included
+         */
+        std::vector<JiraSprint> sprints(int board_id) const;
+
+        /**
+         * @brief Replace the sprint list of the board and mark it as fresh
+         *
+         * @param [in] board_id ID of the board
+         * @param [in] sprints all sprints of the board, issues are ignored
+         */
+        void setSprints(int board_id, std::vector<JiraSprint> sprints);
+
+        /**
+         * @brief Mark sprint lists of all boards as not fresh
+         *
+         * Known sprints stay in the index, the client refreshes only not closed ones.
+         */
+        void expire();
+
+        /**
+         * @brief Select sprints of the board by names
+         *
+         * @param [in] board_id ID of the board
+         * @param [in] names names of required sprints
+         * @return std::vector<JiraSprint> found sprints sorted by start date
+         */
+        std::vector<JiraSprint> sprintsByNames(int board_id, const std::set<std::string>& names) const;
+
+        /**
+         * @brief Select sprints of the board which started after `start` and were completed before `end`
+         *
+         * Not completed sprints that started inside the interval are selected too.
+         *
+         * @param [in] board_id ID of the board
+         * @param [in] start beginning of the interval
+         * @param [in] end end of the interval
+         * @return std::vector<JiraSprint> found sprints sorted by start date
+         */
+        std::vector<JiraSprint> sprintsBetween(int board_id, time_t start, time_t end) const;
+
+        /**
+         * @brief Load the index saved by save()
+         *
+         * Damaged entries are skipped: a board name with a wrong id, or the whole sprint
+         * list of a board if any of its sprints is malformed.
+         *
+         * @param [in] path file with the index
+         * @return true if the file was read, false if it is missing or not an index file
+         */
+        bool load(const std::string& path);
+
+        /**
+         * @brief Save the index into a file
+         *
+         * @param [in] path file for the index, replaced atomically
+         */
+        void save(const std::string& path) const;
+
+    private:
+        struct BoardSprints {
+            std::vector<JiraSprint> sprints;                    /** < sorted by start date */
+            std::unordered_map<std::string, size_t> by_name;    /** < sprint name -> position in sprints */
+            bool fresh = false;
+        };
+
+        static void rebuild(BoardSprints& board);
+
+        std::unordered_map<std::string, int> boards;
+        std::unordered_map<int, BoardSprints> board_sprints;
+        mutable std::mutex mutex;
+};
+
+#endif // BOARD_INDEX_H_
@@ -0,0 +1,101 @@
+/**
+ * @file columns.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Columnar view of sprint issues and counting kernels on top of it
+ * @version 0.1
+ * @date 2020-06-27
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef COLUMNS_H_
+#define COLUMNS_H_
+
+#include <jira/types.hpp>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief How a finished issue is counted in personal results
+ */
+enum IssueCategory : uint8_t {
+    CountedSubtask = 0,     /** < Subtasks, story points are counted */
+    CountedIssue = 1,       /** < Tasks, Enablers and Technical Debts, story points are counted */
+    CountedBug = 2,         /** < Bugs, story points are counted */
+    CountedStory = 3,       /** < User-Stories, counted as issues but story points belong to subtasks */
+    CountedOther = 4,       /** < Everything else */
+    CATEGORIES_COUNT = 5
+};
+
+/**
+ * @brief Totals of finished issues for one person in one sprint
+ */
+struct PersonTally {
+    int subtasks = 0;       /** < Finished subtasks */
+    int issues = 0;         /** < Finished tasks, enablers, debts and stories */
+    int bugs = 0;           /** < Finished bugs */
+    int others = 0;         /** < Finished issues of other types */
+    int story_points = 0;   /** < Story points of finished issues */
+};
+
+/**
+ * @brief Structure-of-arrays copy of sprint issues
+ *
+ * Every field used for counting is stored in its own contiguous array, so counting
+ * kernels read only the data they need and compilers can vectorize the loops.
+ * Rows of all columns with the same index belong to the same issue.
+ */
+class SprintColumns {
+    public:
+        std::vector<uint8_t> category;          /** < IssueCategory of each issue */
+        std::vector<int32_t> story_points;      /** < Story points estimation */
+        std::vector<AccountHandle> assignee;    /** < Handle of assigned user */
+        std::vector<uint8_t> resolved;          /** < 1 if the issue was resolved */
+        std::vector<int64_t> resolution_date;   /** < When the issue was resolved */
+
+        /**
+         * @brief Build columns for all issues of the sprint
+         *
+         * @param [in] sprint sprint with already loaded issues
+         * @return SprintColumns columnar copy of issues
+         */
+        static SprintColumns fromSprint(const JiraSprint& sprint);
+
+        /**
+         * @brief Append one issue to the end of all columns
+         *
+         * @param [in] issue issue to add
+         */
+        void append(const JiraIssue& issue);
+
+        /**
+         * @brief Get number of stored issues
+         *
+         * @return size_t number of rows in every column
+         */
+        size_t size() const;
+
+        /**
+         * @brief Count issues finished before the end of the sprint for all people at once
+         *
+         * A single pass over the columns: an issue is finished when it was resolved
+         * before `sprint_end`, its row is added to the tally of its assignee.
+         *
+         * @param [in] people handles of tracked people, may contain duplicates
+         * @param [in] sprint_end end of the sprint
+         * @return std::vector<PersonTally> tallies in the same order as people, a handle listed
+         * twice gets two equal tallies
+         */
+        std::vector<PersonTally> countFinished(const std::vector<AccountHandle>& people, time_t sprint_end) const;
+
+        /**
+         * @brief Get counting category of an issue type
+         *
+         * @param [in] type type of the issue
+         * @return IssueCategory how finished issues of this type are counted
+         */
+        static IssueCategory categorize(IssueType type);
+};
+
+#endif // COLUMNS_H_
@@ -0,0 +1,126 @@
+/**
+ * @file executor.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Pool of threads which runs asynchronous requests of the client
+ * @version 0.1
+ * @date 2020-06-30
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef EXECUTOR_H_
+#define EXECUTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed pool of threads which steal tasks from each other
+ *
+ * Every thread has its own queue. Tasks submitted by a task of the executor go to
+ * the queue of its thread and are taken newest first, so a task and its subtasks
+ * stay on one thread while others are busy. Tasks submitted from outside go to
+ * a shared queue and are started in the order they were submitted. An idle thread
+ * takes tasks from its own queue, then from the shared one, then steals the oldest
+ * task of another thread. A result (or an exception) of each task is delivered
+ * through std::future.
+ *
+ * The executor can be shared by several clients. A task may wait for its subtasks
+ * with wait(), which runs queued tasks meanwhile instead of blocking the thread.
+ * When the executor is destroyed, already submitted tasks are finished first.
+ */
+class Executor {
+    public:
+        /**
+         * @brief Start the threads of the executor
+         *
+         * @param [in] threads number of threads, at least 1
+         */
+        explicit Executor(size_t threads);
+
+        /**
+         * @brief Finish all submitted tasks and stop the threads
+         */
+        ~Executor();
+
+        Executor(const Executor&) = delete;
+        Executor& operator=(const Executor&) = delete;
+
+        /**
+         * @brief Run the task on one of the threads
+         *
+         * @tparam F callable without arguments
+         * @param [in] task what to run
+         * @return std::future with the value returned by the task or its exception
+         */
+        template <class F>
+        auto submit(F task) -> std::future<decltype(task())> {
+            typedef decltype(task()) Result;
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+            std::future<Result> result = packaged->get_future();
+            post([packaged]() { (*packaged)(); });
+            return result;
+        }
+
+        /**
+         * @brief Wait for the result, running queued tasks meanwhile
+         *
+         * Unlike std::future::wait() it doesn't occupy a thread of the executor, so
+         * tasks can wait for the tasks they submitted without a deadlock.
+         *
+         * @param [in] result future of a submitted task
+         */
+        template <class T>
+        void wait(const std::future<T>& result) {
+            while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (!runPending()) {
+                    result.wait_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+
+        /**
+         * @brief Run one queued task on the calling thread
+         *
+         * @return true if a task was run, false if there were no queued tasks
+         */
+        bool runPending();
+
+        /**
+         * @brief Get number of threads
+         *
+         * @return size_t number of threads
+         */
+        size_t size() const;
+
+    private:
+        typedef std::function<void()> Task;
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void post(Task task);
+        void run(size_t index);
+        bool take(size_t index, Task& task);
+
+        std::vector<std::thread> threads;
+        std::vector<std::unique_ptr<Queue>> queues;    /** < queue of each thread */
+        Queue shared;                                   /** < tasks submitted from outside */
+        std::atomic<size_t> pending;                    /** < submitted tasks which are not taken yet */
+        std::mutex mutex;
+        std::condition_variable ready;
+        bool stopping = false;
+};
+
+#endif // EXECUTOR_H_
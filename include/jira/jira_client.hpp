@@ -13,9 +13,48 @@
 #define JIRA_CLIENT_H_
 
 #include <jira/types.hpp>
+#include <jira/arena.hpp>
+#include <jira/board_index.hpp>
+#include <jira/executor.hpp>
+#include <jira/metrics.hpp>
+#include <jira/session_pool.hpp>
+#include <jira/pagination.hpp>
+#include <jira/scheduler.hpp>
+#include <jira/sprint_cache.hpp>
+#include <jira/transport.hpp>
+#include <jira/user_directory.hpp>
+#include <atomic>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <set>
 
+// Fields of issues read by JiraIssue::fromJSON and by the delta sync of cached sprints
+const std::string DEFAULT_ISSUE_FIELDS = "summary,issuetype,assignee,status,resolution,resolutiondate,parent,subtasks,comment,updated,sprint," + STORY_POINTS_FIELD;
+
+/**
+ * @brief What is requested for every issue of a sprint
+ */
+struct IssueQuery {
+    std::string fields = DEFAULT_ISSUE_FIELDS;  /** < Comma-separated fields of issues, empty to get all fields */
+    std::string expand;                         /** < Comma-separated `expand` values, empty for none */
+    std::string comment_clause;                 /** < JQL matching issues commented by a person, `{account}` is replaced with the account id */
+};
+
+/**
+ * @brief Client for Jira REST and Agile APIs
+ * 
+ * All users, sprints, issues and results returned by the client are owned by it
+ * and stay valid until the client is destroyed, then they are freed all together.
+ * 
+ * Every request method has an asynchronous version which runs on the executor of
+ * the client and returns std::future, so user lookups, board resolution and sprint
+ * fetching can be in flight at the same time. The client is thread-safe: several
+ * boards can be requested at once, they share connections, the board index, the
+ * cache and found users, and only requests for the same board wait for each other.
+ */
 class JiraClient {
     public:
         
@@ -25,8 +64,22 @@ class JiraClient {
          * @param [in] base_url URL to the atlassian jira website
          * @param [in] username username which will be used makigna connection to jira
          * @param [in] api_token token for the username for a connection with jira api
+         * @param [in] options settings for pooled connections (compression, HTTP/2, timeouts)
+         */
+        JiraClient(const std::string base_url, const std::string username, const std::string api_token, const SessionOptions options = SessionOptions());
+
+        /**
+         * @brief Construct a new Jira Client object which sends requests through the transport
+         * 
+         * Credentials are the business of the transport. Useful for recorded responses
+         * (ReplayTransport) and local test servers.
+         * 
+         * @param [in] base_url URL to the atlassian jira website
+         * @param [in] transport backend for all requests
+         * 
+         * @throws std::invalid_argument Thrown if `/myself` request fails.
          */
-        JiraClient(const std::string base_url, const std::string username, const std::string api_token);
+        JiraClient(const std::string base_url, std::shared_ptr<Transport> transport);
         
         /**
          * @brief Destroy the Jira Client object
@@ -38,7 +91,7 @@ class JiraClient {
          *
          * @param [in] surname the surname of Jira user for a search. Must be the same with Jira surname.
          *
-         * @return the user object that has required surname
+         * @return the user object that has required surname, the same object for the same surname
          *
          * @throws std::invalid_argument Thrown if a user with `surname` was not found.
          * @throws std::invalid_argument Thrown if more than one user with `surname` was found.
@@ -46,6 +99,22 @@ class JiraClient {
          * @exceptsafe Strong exception guarantee.
          */
         JiraUser* getPerson(const std::string surname);
+
+        /**
+         * @brief Find several users at once
+         * 
+         * Names found during the last `ttl` seconds (see setUserTtl()) are taken from
+         * the user directory without requests. Known but stale names are checked by
+         * their account ids, unknown names are searched. All requests are sent at the
+         * same time, the directory is saved once at the end.
+         * 
+         * @param [in] surnames names of Jira users, see getPerson()
+         * @return std::vector<JiraUser*> users in the same order as names
+         * 
+         * @throws std::invalid_argument Thrown like getPerson() for the first bad name,
+         * after all other lookups are finished.
+         */
+        std::vector<JiraUser*> getPersons(const std::vector<std::string>& surnames);
         
         /**
          * @brief Get the Sprint that matches exact name
@@ -65,6 +134,79 @@ class JiraClient {
          * @return std::vector<JiraSprint*> List of filtered by date sprints
          */
         std::vector<JiraSprint*> getSprints(const std::string board_name, const std::string start_date, const std::string end_date);
+
+        /**
+         * @brief Find sprints by names without downloading their issues
+         * 
+         * @param [in] board_name Name of the board that will be used a source of the sprints
+         * @param [in] sprint_names List of all names of sprints to search
+         * @return std::vector<JiraSprint*> found sprints sorted by start date, issues are not loaded
+         */
+        std::vector<JiraSprint*> findSprints(const std::string board_name, std::set<std::string> sprint_names);
+
+        /**
+         * @brief Find sprints between two dates without downloading their issues
+         * 
+         * @param [in] board_name Name of the board that will be used a source of the sprints
+         * @param [in] start_date Counting sprints started after this date
+         * @param [in] end_date Counting sprints ended before this date
+         * @return std::vector<JiraSprint*> found sprints sorted by start date, issues are not loaded
+         */
+        std::vector<JiraSprint*> findSprints(const std::string board_name, const std::string start_date, const std::string end_date);
+
+        /**
+         * @brief Download issues of sprints returned by findSprints()
+         * 
+         * getSprints() is findSprints() followed by this method. Issues of each sprint
+         * must be loaded only once.
+         * 
+         * @param [in] sprints sprints without issues
+         */
+        void loadIssues(const std::vector<JiraSprint*>& sprints);
+
+        /**
+         * @brief Forget that sprint lists of boards are up to date
+         * 
+         * Sprint lists are requested once per client. After this call the next request
+         * for a board asks Jira for its active and future sprints again, so new and
+         * just closed sprints are found. Useful for long-running processes.
+         */
+        void expireSprintLists();
+
+        /**
+         * @brief Find a user in Jira database without blocking the caller
+         * 
+         * @param [in] surname the surname of Jira user for a search
+         * @return std::future<JiraUser*> the user, or an exception thrown by getPerson()
+         */
+        std::future<JiraUser*> getPersonAsync(const std::string surname);
+
+        /**
+         * @brief Find several users without blocking the caller
+         * 
+         * @param [in] surnames names of Jira users
+         * @return std::future<std::vector<JiraUser*>> users, or an exception thrown by getPersons()
+         */
+        std::future<std::vector<JiraUser*>> getPersonsAsync(const std::vector<std::string> surnames);
+
+        /**
+         * @brief Get sprints by names without blocking the caller
+         * 
+         * @param [in] board_name Name of the board that will be used a source of the sprints
+         * @param [in] sprint_names List of all names of sprints to search
+         * @return std::future<std::vector<JiraSprint*>> sprints with loaded issues, see getSprints()
+         */
+        std::future<std::vector<JiraSprint*>> getSprintsAsync(const std::string board_name, std::set<std::string> sprint_names);
+
+        /**
+         * @brief Get sprints between two dates without blocking the caller
+         * 
+         * @param [in] board_name Name of the board that will be used a source of the sprints
+         * @param [in] start_date Counting sprints started after this date
+         * @param [in] end_date Counting sprints ended before this date
+         * @return std::future<std::vector<JiraSprint*>> sprints with loaded issues, see getSprints()
+         */
+        std::future<std::vector<JiraSprint*>> getSprintsAsync(const std::string board_name, const std::string start_date, const std::string end_date);
         
         /**
          * @brief Get reults for the person in the exact sprint
@@ -74,12 +216,171 @@ class JiraClient {
          * @return PersonalResult* Object with all results
          */
         PersonalResult* getPersonResults(const JiraUser& user, const JiraSprint& sprint);
+
+        /**
+         * @brief Get results for all people in the exact sprint
+         * 
+         * Walks through the sprint only once, so it is much cheaper than calling
+         * getPersonResults() for each person.
+         * 
+         * @param [in] people For whom method will count results
+         * @param [in] sprint Sprint in which method will look for results
+         * @return std::vector<PersonalResult*> Results in the same order as people
+         */
+        std::vector<PersonalResult*> getSprintResults(const std::vector<JiraUser*>& people, const JiraSprint& sprint);
+
+        /**
+         * @brief Set how many sprints can be fetched in parallel
+         * 
+         * Issues of the selected sprints are requested by tasks on the executor of the client,
+         * each of them parses a response as soon as it arrives. Order of returned sprints
+         * is not affected.
+         * 
+         * @param [in] workers max number of requests in flight, at least 1
+         */
+        void setConcurrency(size_t workers);
+
+        /**
+         * @brief Keep downloaded sprint issues in a local directory
+         * 
+         * Issues of closed sprints are taken from the cache without any requests.
+         * Open sprints which are already in the cache are synchronized incrementally:
+         * a single request per board takes issues updated since the last sync
+         * (`updated >= -Nm`) and merges them into the cached sprints. That request is
+         * not filtered by people: issues which no longer match them are dropped locally.
+         * 
+         * The index of boards and sprints is saved there too, so the next session needs
+         * only one small request per board to refresh not closed sprints. So is the
+         * directory of found people, see getPersons().
+         * 
+         * @param [in] directory where to keep cached sprints, created if it doesn't exist
+         */
+        void setCacheDirectory(const std::string directory);
+
+        /**
+         * @brief Set how long found people are used without asking Jira
+         * 
+         * @param [in] seconds lifetime of entries of the user directory, a week by default
+         */
+        void setUserTtl(double seconds);
+
+        /**
+         * @brief Run asynchronous requests on the given executor
+         * 
+         * By default the client has its own executor. An application can share one
+         * executor between several clients and its own tasks. Must be called before
+         * any asynchronous method.
+         * 
+         * @param [in] executor executor for asynchronous requests
+         */
+        void setExecutor(std::shared_ptr<Executor> executor);
+
+        /**
+         * @brief Set the rate of requests and how failed requests are retried
+         * 
+         * All requests of the client go through one scheduler. Throttled (429) requests
+         * are retried after `Retry-After`, 5xx responses after a jittered backoff.
+         * 
+         * @param [in] options rate limit, retries and limits of requests in flight
+         */
+        void setRateLimit(const SchedulerOptions options);
+
+        /**
+         * @brief Get counters of sent, throttled and retried requests
+         * 
+         * @return SchedulerStats counters since the client was created
+         */
+        SchedulerStats requestStats() const;
+
+        /**
+         * @brief Get performance counters of the client
+         * 
+         * Latency and size of requests by endpoint, JSON parsing, created objects and
+         * aggregation time. Use Metrics::save() to dump them at the end of a run.
+         * 
+         * @return const Metrics& counters since the client was created
+         */
+        const Metrics& getMetrics() const;
+
+        /**
+         * @brief Set which fields of issues are requested
+         * 
+         * By default only the fields used for counting are requested. Must be called
+         * before sprints are requested.
+         * 
+         * @param [in] query fields, expand and the JQL template for commented issues
+         */
+        void setIssueQuery(const IssueQuery query);
+
+        /**
+         * @brief Download only issues of the given people
+         * 
+         * Adds `assignee in (...)` to JQL of sprint issues. Issues where the people
+         * only left comments are not downloaded unless IssueQuery::comment_clause is set
+         * (plain JQL can't search by comment author, e.g. ScriptRunner's
+         * `issueFunction in commented("by {account}")` can), so reviews may be undercounted.
+         * Must be called before sprints are requested.
+         * 
+         * @param [in] people tracked people, empty to download all issues
+         */
+        void setTrackedPeople(const std::vector<JiraUser*>& people);
+
+        /**
+         * @brief Set what is kept from downloaded issues
+         * 
+         * By default comments keep only their size and a short preview. Pages of
+         * issues are parsed by simdjson when the library is built with it, and issues
+         * of a page are mapped by tasks on the executor.
+         * Must be called before sprints are requested.
+         * 
+         * @param [in] options settings for parsing of issues
+         */
+        void setParseOptions(const ParseOptions options);
     private:
+        int findBoard(const std::string& board_name);
+        std::mutex& boardLock(int board_id);
+        void refreshSprints(int board_id);
+        std::vector<JiraSprint*> takeSprints(const std::vector<JiraSprint>& selected);
+        void saveIndex();
+        JiraUser* findPerson(const std::string& surname);
+        JiraUser* searchPerson(const std::string& surname);
+        JiraUser* checkPerson(const std::string& surname, const UserDirectory::Entry& entry);
+        JiraUser* rememberPerson(const std::string& surname, JiraUser* user);
+        void saveUsers();
+        std::map<int, CachedSprint> syncOpenSprints(const std::vector<JiraSprint*>& sprints);
+        static void mergeIssue(CachedSprint& entry, const nlohmann::json& json_issue, bool belongs);
+        void fetchIssues(JiraSprint& sprint, CachedSprint* synced);
+        void fetchIssues(const std::vector<JiraSprint*>& sprints);
+        std::map<std::string, std::string> issueParams(const std::string& jql, bool filter_people = true) const;
+        std::string peopleFilter() const;
+        bool tracksIssue(const nlohmann::json& json_issue) const;
+        std::string queryKey() const;
+        PageIterator paginate(const std::string url, const std::map<std::string, std::string> params, const std::string items_key, const std::string description);
+        PageIterator::PageLoader pageLoader(const std::string url, const std::map<std::string, std::string> params, const std::string description);
+
+
         std::string api_url;
         std::string agile_url;
         std::string user;
-        std::string token;
-        
+        Metrics metrics;
+        std::shared_ptr<Transport> transport;
+        std::unique_ptr<RequestScheduler> scheduler;
+        JiraArena arena;
+        BoardIndex index;
+        size_t fetch_workers = 4;
+        std::unique_ptr<SprintCache> cache;
+        IssueQuery issue_query;
+        ParseOptions parse_options;
+        std::vector<std::string> tracked_accounts;
+        std::mutex board_mutex;
+        std::map<int, std::unique_ptr<std::mutex>> board_locks;    /** < refresh of sprints of each board */
+        std::map<std::string, JiraUser*> people;                  /** < found users by surname */
+        std::mutex people_mutex;
+        UserDirectory users;                                      /** < people found in previous sessions */
+        std::atomic<bool> users_changed{false};
+        // the last member: its threads are stopped before everything they use
+        std::shared_ptr<Executor> executor;
+
 };
 
 #endif // JIRA_CLIENT_H_
\ No newline at end of file
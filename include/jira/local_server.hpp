@@ -0,0 +1,103 @@
+/**
+ * @file local_server.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Minimal HTTP/1.1 server for local endpoints and test doubles
+ * @version 0.1
+ * @date 2020-07-05
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef LOCAL_SERVER_H_
+#define LOCAL_SERVER_H_
+
+#include <jira/session_pool.hpp>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Request received by the LocalHttpServer
+ */
+struct HttpRequest {
+    std::string method;                             /** < GET, POST etc */
+    std::string path;                               /** < Path of the URL without the query */
+    std::map<std::string, std::string> params;      /** < Decoded query parameters */
+    std::map<std::string, std::string> headers;     /** < Request headers, names are in lower case */
+};
+
+/**
+ * @brief Small blocking HTTP server, one thread per connection
+ *
+ * Reads request headers (bodies are skipped), passes the request to the handler
+ * and writes its response with `Content-Length`. Connections are kept alive.
+ * Malformed requests are answered with 400 and bodies over 1 MiB with 413, then
+ * the connection is closed.
+ * It is meant for local use: status pages, test doubles of remote servers.
+ */
+class LocalHttpServer {
+    public:
+        /**
+         * @brief Function which answers requests, called from connection threads
+         */
+        typedef std::function<HttpResponse(const HttpRequest&)> Handler;
+
+        /**
+         * @brief Start the server
+         *
+         * @param [in] handler function which answers requests, exceptions are sent as 500
+         * @param [in] port TCP port, 0 for any free port
+         * @param [in] address IPv4 address to listen on
+         *
+         * @throws std::runtime_error Thrown if the socket cannot be opened.
+         */
+        LocalHttpServer(Handler handler, int port = 0, const std::string address = "127.0.0.1");
+
+        /**
+         * @brief Stop the server
+         */
+        ~LocalHttpServer();
+
+        LocalHttpServer(const LocalHttpServer&) = delete;
+        LocalHttpServer& operator=(const LocalHttpServer&) = delete;
+
+        /**
+         * @brief Get the port the server listens on
+         *
+         * @return int TCP port
+         */
+        int port() const;
+
+        /**
+         * @brief Get the base URL of the server
+         *
+         * @return std::string e.g. http://127.0.0.1:8080
+         */
+        std::string url() const;
+
+        /**
+         * @brief Close the listening socket and all connections, wait for handlers to return
+         */
+        void stop();
+
+    private:
+        void acceptConnections();
+        void serve(int connection);
+
+        Handler handler;
+        std::string address;
+        int listener = -1;
+        int listen_port = 0;
+        std::thread acceptor;
+        std::mutex mutex;
+        std::condition_variable all_closed;
+        std::set<int> connections;
+        bool stopping = false;
+};
+
+#endif // LOCAL_SERVER_H_
@@ -0,0 +1,130 @@
+/**
+ * @file metrics.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Performance counters of the client and their export
+ * @version 0.1
+ * @date 2020-07-03
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Where the client spends time: requests, parsing and aggregation
+ *
+ * - latency histogram, bytes and errors for every endpoint (ids in URLs are replaced with `{id}`);
+ * - time and bytes of JSON parsing;
+ * - time of mapping JSON to objects and number of created objects by type;
+ * - time of aggregation.
+ *
+ * Counters only grow during the life of the client. All methods are thread-safe.
+ */
+class Metrics {
+    public:
+        /**
+         * @brief Upper bounds of latency histogram buckets in seconds, +Inf is implied
+         */
+        static const std::vector<double> LATENCY_BUCKETS;
+
+        /**
+         * @brief Count one HTTP exchange
+         *
+         * @param [in] url requested URL, query is ignored
+         * @param [in] status_code status of the response, 0 for transport errors
+         * @param [in] seconds time spent on the request
+         * @param [in] bytes size of the response body
+         */
+        void recordRequest(const std::string& url, long status_code, double seconds, size_t bytes);
+
+        /**
+         * @brief Count parsing of one JSON document
+         *
+         * @param [in] seconds time spent on parsing
+         * @param [in] bytes size of the document
+         */
+        void recordParse(double seconds, size_t bytes);
+
+        /**
+         * @brief Count objects created from parsed JSON
+         *
+         * @param [in] type type of objects, e.g. "issue"
+         * @param [in] seconds time spent on creating the objects
+         * @param [in] objects number of created objects
+         */
+        void recordMapping(const std::string& type, double seconds, size_t objects);
+
+        /**
+         * @brief Count one aggregation of sprint results
+         *
+         * @param [in] seconds time spent on the aggregation
+         */
+        void recordAggregation(double seconds);
+
+        /**
+         * @brief Export all counters as JSON
+         *
+         * @return nlohmann::json object with "requests", "parse", "objects" and "aggregation"
+         */
+        nlohmann::json toJSON() const;
+
+        /**
+         * @brief Export all counters in Prometheus text format
+         *
+         * @return std::string metrics with `jira_` prefix
+         */
+        std::string toPrometheus() const;
+
+        /**
+         * @brief Write the counters into a file
+         *
+         * @param [in] path file name, Prometheus format for `.prom` files, JSON otherwise
+         */
+        void save(const std::string& path) const;
+
+        /**
+         * @brief Get the endpoint of the URL used as a label
+         *
+         * @param [in] url full URL
+         * @return std::string path of the URL with numeric segments replaced by `{id}`
+         */
+        static std::string endpoint(const std::string& url);
+
+    private:
+        struct Histogram {
+            std::vector<uint64_t> counts = std::vector<uint64_t>(LATENCY_BUCKETS.size() + 1, 0);
+            double sum = 0;
+            uint64_t count = 0;
+
+            void observe(double value);
+        };
+
+        struct EndpointStats {
+            Histogram latency;
+            uint64_t bytes = 0;
+            uint64_t errors = 0;
+        };
+
+        struct Totals {
+            double seconds = 0;
+            uint64_t count = 0;
+        };
+
+        mutable std::mutex mutex;
+        std::map<std::string, EndpointStats> requests;
+        Histogram parse_time;
+        uint64_t parsed_bytes = 0;
+        std::map<std::string, Totals> objects;
+        Totals aggregation;
+};
+
+#endif // METRICS_H_
@@ -0,0 +1,151 @@
+/**
+ * @file pagination.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Iterator over paginated Jira API responses
+ * @version 0.1
+ * @date 2020-06-16
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef PAGINATION_H_
+#define PAGINATION_H_
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <string>
+#include <nlohmann/json.hpp>
+
+class Metrics;
+
+/**
+ * @brief Pagination fields of a page which is parsed outside of PageIterator
+ */
+struct PageEnvelope {
+    int start_at = 0;       /** < "startAt" of the page */
+    int received = 0;       /** < Number of items in the page */
+    int max_results = -1;   /** < "maxResults", -1 if the page has no such field */
+    int total = -1;         /** < "total", -1 if the page has no such field */
+    int is_last = -1;       /** < "isLast" as 1 or 0, -1 if the page has no such field */
+};
+
+/**
+ * @brief Walks through all pages of a paginated Jira resource
+ *
+ * Jira returns lists by pages with `startAt`, `maxResults` and either
+ * `isLast` (agile API) or `total` fields. The iterator follows pages until the
+ * last one and requests page N+1 in background as soon as page N is received,
+ * so the caller parses one page while the next one is on the way.
+ *
+ * The next page is requested on its own thread, not on the shared Executor:
+ * iterators are read under locks of the client (the board list is loaded under
+ * the board mutex), and waiting for a task of the Executor runs other queued
+ * tasks on the waiting thread, which may take the same lock and never return.
+ *
+ * @code
+ * PageIterator pages(loader, "values");
+ * while (pages.next()) {
+ *     for (const auto& item : pages.items()) { ... }
+ * }
+ * @endcode
+ */
+class PageIterator {
+    public:
+        /**
+         * @brief Function which downloads a page starting from the provided index
+         *
+         * It has to return a body of the page or throw if the page cannot be received.
+         */
+        typedef std::function<std::string(int start_at)> PageLoader;
+
+        /**
+         * @brief Function which parses a page body and takes its items
+         *
+         * It is called once for every page, before next() returns.
+         */
+        typedef std::function<PageEnvelope(const std::string& body)> PageParser;
+
+        /**
+         * @brief Construct a new Page Iterator object
+         *
+         * @param [in] loader function which downloads one page
+         * @param [in] items_key name of the array with items inside the page ("values", "issues" etc)
+         * @param [in] metrics where parsing of pages is counted, nullptr to skip counting
+         */
+        PageIterator(PageLoader loader, const std::string items_key, Metrics* metrics = nullptr);
+
+        /**
+         * @brief Construct a Page Iterator which leaves parsing to the caller
+         *
+         * Items are taken by the parser, items() and page() stay empty. Time of the
+         * parser is counted as parsing of the page.
+         *
+         * @param [in] loader function which downloads one page
+         * @param [in] parser function which parses one page
+         * @param [in] metrics where parsing of pages is counted, nullptr to skip counting
+         */
+        PageIterator(PageLoader loader, PageParser parser, Metrics* metrics = nullptr);
+
+        /**
+         * @brief Start from the given item instead of the first one
+         *
+         * Must be called before the first next().
+         *
+         * @param [in] items number of items to skip
+         */
+        void skip(int items);
+
+        /**
+         * @brief Move to the next page
+         *
+         * Waits for the next page, parses it and starts loading of the page after it.
+         *
+         * @return true if a new page was loaded, false if all pages were already read
+         *
+         * @throws std::exception Thrown by the loader or the parser. The iterator stays failed:
+         * every next call throws the same exception.
+         */
+        bool next();
+
+        /**
+         * @brief Get items of the current page
+         *
+         * @return const nlohmann::json& array of items, valid until the next call of next()
+         */
+        const nlohmann::json& items() const;
+
+        /**
+         * @brief Get the current page as it was returned by Jira
+         *
+         * @return const nlohmann::json& the whole page, valid until the next call of next()
+         */
+        const nlohmann::json& page() const;
+
+        /**
+         * @brief Take pagination fields from a parsed page
+         *
+         * @param [in] page the whole page
+         * @param [in] items_key name of the array with items
+         * @return PageEnvelope fields of the page
+         */
+        static PageEnvelope envelope(const nlohmann::json& page, const std::string& items_key);
+
+    private:
+        void prefetch(int start_at);
+        PageEnvelope parse(const std::string& body);
+
+        PageLoader loader;
+        PageParser parser;
+        std::string items_key;
+        Metrics* metrics;
+        nlohmann::json current;
+        std::future<std::string> pending;
+        std::exception_ptr error;
+        int first = 0;
+        bool finished = false;
+        bool started = false;
+};
+
+#endif // PAGINATION_H_
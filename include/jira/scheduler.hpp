@@ -0,0 +1,146 @@
+/**
+ * @file scheduler.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Rate limiting, retries and adaptive concurrency for Jira requests
+ * @version 0.1
+ * @date 2020-07-01
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <jira/metrics.hpp>
+#include <jira/transport.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Settings of the RequestScheduler
+ */
+struct SchedulerOptions {
+    double requests_per_second = 20;   /** < Average rate of outgoing requests */
+    double burst = 20;                  /** < How many requests can be sent at once after a pause */
+    size_t max_retries = 5;             /** < Retries of a throttled or failed request before giving up */
+    double base_backoff = 0.5;          /** < First retry delay in seconds, doubled on every next retry */
+    double max_backoff = 30;            /** < Upper limit of a retry delay in seconds */
+    size_t min_concurrency = 1;         /** < Lower limit of requests in flight */
+    size_t max_concurrency = 16;        /** < Upper limit of requests in flight */
+};
+
+/**
+ * @brief Counters of the RequestScheduler
+ */
+struct SchedulerStats {
+    uint64_t requests = 0;      /** < Requests sent to the server, including retries */
+    uint64_t throttled = 0;     /** < Responses with 429 Too Many Requests */
+    uint64_t retried = 0;       /** < Requests sent again after 429, 5xx or a transport error */
+    uint64_t failed = 0;        /** < Requests which still failed after all retries */
+    double concurrency = 0;     /** < Current limit of requests in flight */
+};
+
+/**
+ * @brief The single point through which the client sends requests to Jira
+ *
+ * - a token bucket meters the rate of outgoing requests;
+ * - 429 responses pause all requests for `Retry-After` (or a backoff delay if the
+ *   header is missing), at most for `max_backoff`, and are retried; so do 503
+ *   responses with `Retry-After`;
+ * - 5xx responses and transport errors are retried after a jittered exponential backoff;
+ * - the limit of requests in flight starts at `min_concurrency`, grows by one per round
+ *   of successful requests and halves on every throttled or overloaded response (AIMD).
+ *
+ * The scheduler is thread-safe. When all retries are spent the last response is returned,
+ * so callers check status codes as before.
+ */
+class RequestScheduler {
+    public:
+        /**
+         * @brief Construct a new Request Scheduler object
+         *
+         * @param [in] transport backend used for requests, must outlive the scheduler
+         * @param [in] options rate and retry settings
+         * @param [in] metrics where every sent request is counted, nullptr to skip counting
+         */
+        RequestScheduler(Transport& transport, const SchedulerOptions options = SchedulerOptions(), Metrics* metrics = nullptr);
+
+        /**
+         * @brief Make a GET request when the rate limit allows it, retry if needed
+         *
+         * @param [in] url full URL of the resource
+         * @param [in] params query parameters, will be url-encoded
+         * @return HttpResponse the successful response or the last failed one
+         */
+        HttpResponse get(const std::string& url, const std::map<std::string, std::string>& params = {});
+
+        /**
+         * @brief Replace rate and retry settings
+         *
+         * Should be called before requests are sent, the limit of requests in flight is reset
+         * to `min_concurrency`.
+         *
+         * @param [in] options new settings
+         */
+        void setOptions(const SchedulerOptions options);
+
+        /**
+         * @brief Get counters of sent, throttled and retried requests
+         *
+         * @return SchedulerStats snapshot of the counters
+         */
+        SchedulerStats stats() const;
+
+        /**
+         * @brief Get the delay requested by a `Retry-After` header
+         *
+         * @param [in] value value of the header: seconds or an HTTP date
+         * @param [in] now current time, used for HTTP dates
+         * @return double delay in seconds, -1 if the value is incorrect
+         */
+        static double retryAfter(const std::string& value, time_t now);
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        // a slot of requests in flight, given back even if the transport throws
+        class Slot {
+            public:
+                explicit Slot(RequestScheduler& scheduler);
+                ~Slot();
+                bool overloaded = false;
+
+            private:
+                RequestScheduler& scheduler;
+        };
+
+
+        void acquire();
+        void release(bool overloaded);
+        void pause(double seconds);
+        double backoff(size_t attempt) const;
+
+        Transport& transport;
+        Metrics* metrics;
+        SchedulerOptions options;
+        mutable std::mutex mutex;
+        std::condition_variable slot_released;
+        double tokens;
+        Clock::time_point refilled_at;
+        Clock::time_point paused_until;
+        double concurrency;
+        size_t in_flight = 0;
+        std::atomic<uint64_t> requests;
+        std::atomic<uint64_t> throttled;
+        std::atomic<uint64_t> retried;
+        std::atomic<uint64_t> failed;
+};
+
+#endif // SCHEDULER_H_
@@ -0,0 +1,101 @@
+/**
+ * @file session_pool.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Pool of persistent HTTP sessions used for all Jira API requests
+ * @version 0.1
+ * @date 2020-06-14
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef SESSION_POOL_H_
+#define SESSION_POOL_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cpr {
+    class Session;
+}
+
+/**
+ * @brief Result of a single HTTP request
+ */
+struct HttpResponse {
+    long status_code = 0;                           /** < HTTP status code, 0 if request was not sent at all */
+    std::string text;                               /** < Body of the response (already decompressed) */
+    std::map<std::string, std::string> headers;     /** < Response headers, names are in lower case */
+    double elapsed = 0;                             /** < Time spent on the request in seconds */
+    std::string error;                              /** < Transport error message when status_code is 0 */
+};
+
+/**
+ * @brief Settings for connections opened by the SessionPool
+ */
+struct SessionOptions {
+    bool compression = true;        /** < Ask Jira for gzip/deflate encoded responses */
+    bool http2 = false;             /** < Negotiate HTTP/2 over TLS if server supports it, requests are not multiplexed */
+    long timeout_ms = 60000;        /** < Timeout for one request in milliseconds */
+    size_t max_idle = 8;            /** < How many idle sessions are kept alive between requests */
+};
+
+/**
+ * @brief Pool of reusable authenticated HTTP sessions
+ *
+ * Each session keeps its connection alive, so consecutive requests skip
+ * TCP and TLS handshakes. DNS and TLS session data are shared between all
+ * sessions of the pool. The pool is thread-safe: every request takes an idle
+ * session (or opens a new one) and puts it back when the response is read.
+ */
+class SessionPool {
+    public:
+        /**
+         * @brief Construct a new Session Pool object
+         *
+         * @param [in] username username for basic authentication
+         * @param [in] api_token api token for basic authentication
+         * @param [in] options settings for all opened connections
+         */
+        SessionPool(const std::string username, const std::string api_token, const SessionOptions options = SessionOptions());
+
+        /**
+         * @brief Destroy the Session Pool object and close all connections
+         */
+        ~SessionPool();
+
+        /**
+         * @brief Make a GET request using one of the pooled sessions
+         *
+         * @param [in] url full URL of the resource
+         * @param [in] params query parameters, will be url-encoded
+         * @return HttpResponse response of the server
+         */
+        HttpResponse get(const std::string& url, const std::map<std::string, std::string>& params = {});
+
+        /**
+         * @brief Get number of sessions opened by the pool so far
+         *
+         * @return size_t number of opened sessions
+         */
+        size_t opened() const;
+
+    private:
+        struct SharedData;
+
+        std::unique_ptr<cpr::Session> acquire();
+        void release(std::unique_ptr<cpr::Session> session);
+
+        std::string user;
+        std::string token;
+        SessionOptions options;
+        std::unique_ptr<SharedData> shared;
+        std::vector<std::unique_ptr<cpr::Session>> idle;
+        mutable std::mutex idle_mutex;
+        size_t opened_count = 0;
+};
+
+#endif // SESSION_POOL_H_
@@ -0,0 +1,247 @@
+/**
+ * @file snapshot.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Binary snapshot of sprints and issues which is read in place through mmap
+ * @version 0.1
+ * @date 2020-07-10
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <jira/arena.hpp>
+#include <jira/columns.hpp>
+#include <jira/types.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Version of the snapshot format, files of other versions are rejected
+ */
+const uint32_t SNAPSHOT_VERSION = 1;
+
+/**
+ * @brief Beginning of a snapshot file, offsets are from the beginning of the file
+ */
+struct SnapshotHeader {
+    char magic[8];              /** < "JIRASNAP" */
+    uint32_t version;           /** < SNAPSHOT_VERSION */
+    uint32_t byte_order;        /** < 0x01020304 written in the byte order of the writer */
+    uint32_t sprint_count;
+    uint32_t issue_count;
+    uint32_t comment_count;
+    uint32_t subtask_count;
+    uint64_t sprints_offset;
+    uint64_t issues_offset;
+    uint64_t comments_offset;
+    uint64_t subtasks_offset;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+};
+
+/**
+ * @brief Reference to a string in the string table of a snapshot
+ *
+ * Strings are stored once and end with '\0', so SnapshotView::data() can be used
+ * as a C string.
+ */
+struct SnapshotString {
+    uint32_t offset;    /** < Position in the string table */
+    uint32_t size;      /** < Length without the terminating '\0' */
+};
+
+/**
+ * @brief Sprint record, its issues are `issue_count` records from `first_issue`
+ */
+struct SnapshotSprint {
+    int32_t id;
+    int32_t board_id;
+    int64_t start_date;
+    int64_t end_date;
+    int64_t complete_date;
+    SnapshotString name;
+    uint32_t first_issue;
+    uint32_t issue_count;
+    uint8_t closed;
+    uint8_t reserved[7];
+};
+
+/**
+ * @brief Issue record, its comments and subtask ids are stored in their own arrays
+ */
+struct SnapshotIssue {
+    SnapshotString id;
+    SnapshotString key;
+    SnapshotString title;
+    SnapshotString parent_id;
+    SnapshotString status_id;
+    SnapshotString status_name;
+    SnapshotString assignee;        /** < Account id, empty for unassigned issues */
+    int64_t resolution_date;
+    int32_t type;                   /** < IssueType */
+    int32_t story_points;
+    uint32_t first_comment;
+    uint32_t comment_count;
+    uint32_t first_subtask;
+    uint32_t subtask_count;
+    uint8_t resolved;
+    uint8_t reserved[7];
+};
+
+/**
+ * @brief Comment record
+ */
+struct SnapshotComment {
+    SnapshotString id;
+    SnapshotString author;          /** < Account id of the author */
+    SnapshotString text;
+    SnapshotString preview;
+    int64_t published_date;
+    uint64_t length;
+    uint64_t lines;
+};
+
+/**
+ * @brief Collects sprints with issues and saves them as a snapshot
+ *
+ * Layout of the file (native byte order, every section is 8-byte aligned):
+ * header, sprint records, issue records, comment records, subtask ids, string table.
+ * Records refer to each other by indexes and to strings by offsets, so the file is
+ * used as is after mmap.
+ */
+class SnapshotWriter {
+    public:
+        /**
+         * @brief Add a sprint with its loaded issues
+         *
+         * @param [in] sprint the sprint
+         */
+        void add(const JiraSprint& sprint);
+
+        /**
+         * @brief Save all added sprints
+         *
+         * @param [in] path file for the snapshot, replaced atomically
+         *
+         * @throws std::runtime_error Thrown if the file cannot be written.
+         */
+        void save(const std::string& path) const;
+
+    private:
+        SnapshotString string(const std::string& value);
+
+        std::vector<SnapshotSprint> sprints;
+        std::vector<SnapshotIssue> issues;
+        std::vector<SnapshotComment> comments;
+        std::vector<SnapshotString> subtasks;
+        std::string strings;
+        std::unordered_map<std::string, SnapshotString> known_strings;
+};
+
+/**
+ * @brief Read-only view of a snapshot file mapped into memory
+ *
+ * Opening checks only the header and that all sections stay inside the file, nothing
+ * is parsed or copied. Records are read directly from the mapped pages, which are
+ * shared by all processes that map the same file. References and issue types of a
+ * record are checked when the record is read, so a damaged record makes its accessor
+ * throw std::runtime_error. The view is thread-safe.
+ */
+class SnapshotView {
+    public:
+        /**
+         * @brief Map the snapshot
+         *
+         * @param [in] path file saved by SnapshotWriter
+         *
+         * @throws std::runtime_error Thrown if the file cannot be mapped, is not a snapshot,
+         * has another version or byte order, or its sections don't fit into the file.
+         */
+        explicit SnapshotView(const std::string path);
+
+        /**
+         * @brief Unmap the snapshot
+         */
+        ~SnapshotView();
+
+        SnapshotView(const SnapshotView&) = delete;
+        SnapshotView& operator=(const SnapshotView&) = delete;
+
+        size_t sprintCount() const;
+        size_t issueCount() const;
+
+        /**
+         * @brief Get a sprint record
+         *
+         * @param [in] index position of the sprint, less than sprintCount()
+         * @return const SnapshotSprint& the record in the mapped file
+         */
+        const SnapshotSprint& sprint(size_t index) const;
+
+        /**
+         * @brief Find a sprint by its ID
+         *
+         * @param [in] sprint_id ID of the sprint
+         * @return int position of the sprint, -1 if there is no such sprint
+         */
+        int findSprint(int sprint_id) const;
+
+        const SnapshotIssue& issue(size_t index) const;
+        const SnapshotComment& comment(size_t index) const;
+        const SnapshotString& subtask(size_t index) const;
+
+        /**
+         * @brief Get the characters of a string in place
+         *
+         * @param [in] value reference from a record
+         * @return const char* null-terminated string in the mapped file
+         */
+        const char* data(const SnapshotString& value) const;
+
+        /**
+         * @brief Copy a string
+         *
+         * @param [in] value reference from a record
+         * @return std::string the string
+         */
+        std::string string(const SnapshotString& value) const;
+
+        /**
+         * @brief Build counting columns of the sprint without creating issues
+         *
+         * @param [in] index position of the sprint
+         * @return SprintColumns columns for SprintColumns::countFinished()
+         */
+        SprintColumns columns(size_t index) const;
+
+        /**
+         * @brief Create the sprint with its issues as regular objects
+         *
+         * For code which needs JiraSprint, e.g. JiraClient::getSprintResults().
+         *
+         * @param [in] index position of the sprint
+         * @param [in] arena storage for created objects, nullptr to allocate with new
+         * @return JiraSprint* the sprint with issues
+         */
+        JiraSprint* toSprint(size_t index, JiraArena* arena = nullptr) const;
+
+    private:
+        void validate() const;
+        void checkString(const SnapshotString& value) const;
+
+        const char* base = nullptr;
+        size_t size = 0;
+        const SnapshotHeader* header = nullptr;
+        const SnapshotSprint* sprint_records = nullptr;
+        const SnapshotIssue* issue_records = nullptr;
+        const SnapshotComment* comment_records = nullptr;
+        const SnapshotString* subtask_records = nullptr;
+        const char* strings = nullptr;
+};
+
+#endif // SNAPSHOT_H_
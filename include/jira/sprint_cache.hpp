@@ -0,0 +1,74 @@
+/**
+ * @file sprint_cache.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Local on-disk storage of downloaded sprint issues
+ * @version 0.1
+ * @date 2020-06-21
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef SPRINT_CACHE_H_
+#define SPRINT_CACHE_H_
+
+#include <ctime>
+#include <string>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Issues of one sprint saved on disk
+ */
+struct CachedSprint {
+    bool closed = false;            /** < Sprint was closed when issues were saved, such entry never expires */
+    time_t synced_at = 0;           /** < Local time when the issues were last synchronized with Jira */
+    std::string query;              /** < Fields and filter the issues were requested with, other queries can't use the entry */
+    nlohmann::json issues = nlohmann::json::array();   /** < Issues exactly as Jira returned them */
+};
+
+/**
+ * @brief Persistent cache of sprint issues keyed by board and sprint id
+ *
+ * Every sprint is stored in its own file `<directory>/board-<id>/sprint-<id>.json`.
+ * Files are replaced atomically, so an interrupted run never leaves a broken entry.
+ */
+class SprintCache {
+    public:
+        /**
+         * @brief Construct a new Sprint Cache object
+         *
+         * @param [in] directory where cached sprints are stored, created if it doesn't exist
+         */
+        SprintCache(const std::string directory);
+
+        /**
+         * @brief Read cached issues of the sprint
+         *
+         * @param [in] board_id ID of the board which includes the sprint
+         * @param [in] sprint_id ID of the sprint
+         * @param [out] entry filled with cached data if it exists
+         * @return true if the sprint was found in the cache
+         */
+        bool load(int board_id, int sprint_id, CachedSprint& entry) const;
+
+        /**
+         * @brief Save issues of the sprint into the cache
+         *
+         * @param [in] board_id ID of the board which includes the sprint
+         * @param [in] sprint_id ID of the sprint
+         * @param [in] entry data to save
+         */
+        void store(int board_id, int sprint_id, const CachedSprint& entry) const;
+
+        /**
+         * @brief Get the directory used by the cache
+         *
+         * @return const std::string& root directory of the cache
+         */
+        const std::string& directory() const;
+
+    private:
+        std::string root;
+};
+
+#endif // SPRINT_CACHE_H_
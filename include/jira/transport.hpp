@@ -0,0 +1,105 @@
+/**
+ * @file transport.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief HTTP backends used by the client: network, record and replay
+ * @version 0.1
+ * @date 2020-07-05
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef TRANSPORT_H_
+#define TRANSPORT_H_
+
+#include <jira/session_pool.hpp>
+#include <map>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Way of sending GET requests to Jira
+ *
+ * Implementations must be thread-safe.
+ */
+class Transport {
+    public:
+        virtual ~Transport() = default;
+
+        /**
+         * @brief Make a GET request
+         *
+         * @param [in] url full URL of the resource
+         * @param [in] params query parameters, will be url-encoded
+         * @return HttpResponse response of the server, status_code is 0 if it was not received
+         */
+        virtual HttpResponse get(const std::string& url, const std::map<std::string, std::string>& params) = 0;
+};
+
+/**
+ * @brief Requests to a real server through pooled cpr sessions
+ */
+class CprTransport : public Transport {
+    public:
+        /**
+         * @brief Construct a new Cpr Transport object
+         *
+         * @param [in] username username for basic authentication
+         * @param [in] api_token api token for basic authentication
+         * @param [in] options settings for pooled connections
+         */
+        CprTransport(const std::string username, const std::string api_token, const SessionOptions options = SessionOptions());
+
+        HttpResponse get(const std::string& url, const std::map<std::string, std::string>& params) override;
+
+    private:
+        SessionPool pool;
+};
+
+/**
+ * @brief Saves responses into files and plays them back without network
+ *
+ * Every request (URL and parameters) is stored in its own file `<directory>/<hash>.json`
+ * with the status, headers and body of the response. In Record mode requests are
+ * passed to the upstream transport and responses are saved, in Replay mode they are
+ * read from the files only.
+ */
+class ReplayTransport : public Transport {
+    public:
+        enum class Mode {
+            Record,     /** < Forward requests to upstream and save responses */
+            Replay      /** < Answer from saved responses only */
+        };
+
+        /**
+         * @brief Construct a new Replay Transport object
+         *
+         * @param [in] directory where responses are stored, created in Record mode
+         * @param [in] mode record or replay
+         * @param [in] upstream transport for Record mode, not used in Replay mode
+         */
+        ReplayTransport(const std::string directory, Mode mode, std::shared_ptr<Transport> upstream = nullptr);
+
+        /**
+         * @brief Make a GET request
+         *
+         * In Replay mode a request without saved response gets status_code 404 and an error.
+         */
+        HttpResponse get(const std::string& url, const std::map<std::string, std::string>& params) override;
+
+        /**
+         * @brief Get the file where the response for the request is stored
+         *
+         * @param [in] url full URL of the resource
+         * @param [in] params query parameters
+         * @return std::string path of the file
+         */
+        std::string path(const std::string& url, const std::map<std::string, std::string>& params) const;
+
+    private:
+        std::string directory;
+        Mode mode;
+        std::shared_ptr<Transport> upstream;
+};
+
+#endif // TRANSPORT_H_
@@ -13,12 +13,61 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 #include <ctime>
 #include <map>
+#include <nlohmann/json_fwd.hpp>
+
+class Executor;
+class JiraArena;
+struct PageEnvelope;
 
 // Jira has a limitation for MAX of items that will be returned by api request 
 const std::string MAX_ISSUES_IN_REQUEST = "200";
 
+// Custom field where story points estimation of an issue is stored
+const std::string STORY_POINTS_FIELD = "customfield_10125";
+
+/**
+ * @brief Small integer which stands for a Jira account id
+ * 
+ * Account ids are long strings repeated in every issue and comment, so they are
+ * stored once in AccountIndex and objects keep only handles. Equal ids always
+ * have equal handles within the process.
+ */
+typedef uint32_t AccountHandle;
+
+const AccountHandle NO_ACCOUNT = 0;     /** < Handle used when there is no account (e.g. unassigned issue) */
+
+/**
+ * @brief Process-wide interning table of account ids, thread-safe
+ */
+class AccountIndex {
+    public:
+        /**
+         * @brief Get a handle for the account id, registers the id if it is new
+         * 
+         * @param [in] account_id ID of the user in Jira Database
+         * @return AccountHandle handle of the account, NO_ACCOUNT for an empty id
+         */
+        static AccountHandle intern(const std::string& account_id);
+
+        /**
+         * @brief Get the account id by its handle
+         * 
+         * @param [in] handle handle returned by intern()
+         * @return const std::string& account id, empty for NO_ACCOUNT or unknown handles
+         */
+        static const std::string& accountId(AccountHandle handle);
+
+        /**
+         * @brief Get number of registered accounts, all handles are below this value + 1
+         * 
+         * @return size_t number of known accounts
+         */
+        static size_t size();
+};
+
 /**
  * @brief Issues's statuses like Done, New, In progress etc
  */
@@ -30,16 +79,46 @@ struct IssueStatus {
 /**
  * @brief Comment for the issue
  * 
- * Comment that was written at @published_date by @author_id.
- * Contains a whole message's text.
+ * Comment that was written at @published_date by @author.
+ * Size of the message is always known, the text itself is kept only
+ * in CommentMode::Full.
  */
 struct Comment {
     std::string id;             /** < ID of the comment in a Jira databes */
-    std::string authour_id;     /** < ID of author of the comemnt */
-    std::string text;           /** < Full message's text */
+    AccountHandle author;       /** < Handle of author's account id of the comemnt */
+    std::string text;           /** < Full message's text without newlines, empty in CommentMode::Compact */
+    size_t length = 0;          /** < Number of characters (UTF-8 code points) without newlines */
+    size_t lines = 0;           /** < Number of non-empty lines */
+    std::string preview;        /** < First characters of the message, lines are joined with spaces */
     time_t published_date;      /** < Time when the comment was published (published, not updated!) */
 };
 
+/**
+ * @brief How comment bodies are stored after parsing
+ */
+enum class CommentMode {
+    Compact,    /** < Only length, lines and preview are kept */
+    Full        /** < The whole text is kept too */
+};
+
+/**
+ * @brief Parser of whole pages of issues, see JiraIssue::fromPage()
+ */
+enum class JsonParser {
+    Nlohmann,   /** < nlohmann::json, always available */
+    Simdjson    /** < simdjson, if the library is built with JIRA_USE_SIMDJSON, otherwise nlohmann::json */
+};
+
+/**
+ * @brief Settings of JSON -> object conversion
+ */
+struct ParseOptions {
+    CommentMode comments = CommentMode::Compact;    /** < What is kept from comment bodies */
+    size_t preview_length = 40;                     /** < Characters kept in Comment::preview, 0 for no preview */
+    JsonParser parser = JsonParser::Simdjson;       /** < Parser of pages, the fastest available by default */
+    size_t issues_per_task = 64;                    /** < Issues mapped by one task of the executor */
+};
+
 /**
  * @brief Type of the issue like Bug, User-story etc
  * 
@@ -71,6 +150,7 @@ class JiraUser {
     public:
         std::string id;     /** < ID of the user in Jira Database */
         std::string name;   /** < name displayed of the website */
+        AccountHandle handle = NO_ACCOUNT;  /** < Interned id, used for fast comparisons */
         /**
          * @brief Construct a new Jira User object
          * 
@@ -91,6 +171,16 @@ class JiraUser {
          * @return JiraUser* new object of user with fields values from json
          */
         static JiraUser* fromJSON(const std::string json_string);
+        /**
+         * @brief Creates a JiraUser object from already parsed JSON
+         * 
+         * Same as the string version, but skips parsing of the JSON text.
+         * 
+         * @param [in] json_data parsed JSON representation of the user
+         * @param [in] arena owner of the new object, if nullptr the caller owns the object
+         * @return JiraUser* new object of user with fields values from json
+         */
+        static JiraUser* fromJSON(const nlohmann::json& json_data, JiraArena* arena = nullptr);
 };
 
 /**
@@ -103,7 +193,7 @@ class JiraIssue {
         IssueType type;                 /** < Type of the issue */
         std::string key;                /** < Key of the issue like MPA1-132 */
         std::string title;              /** < Issue's title */
-        std::string assignee_id;        /** < ID of assigned user */
+        AccountHandle assignee = NO_ACCOUNT;    /** < Handle of assigned user's account id */
         IssueStatus status;             /** < Curernt statys of the issue */
         int story_points = 0;           /** < Story Points estimation for the issue */
         bool resolved = false;          /** < Issue was resolved ? true/false */
@@ -128,6 +218,59 @@ class JiraIssue {
          * @return JiraIssue* new object of JiraIssue with fields values from json
          */
         static JiraIssue* fromJSON(const std::string json_string);
+        /**
+         * @brief Creates a JiraIssue object from already parsed JSON
+         * 
+         * Same as the string version, but skips parsing of the JSON text.
+         * 
+         * Comment bodies can be plain strings or Atlassian Document Format trees,
+         * the tree is walked once and only sizes (and the text if options ask for it) are kept.
+         * 
+         * @param [in] json_data parsed JSON representation of the issue
+         * @param [in] arena owner of the new object, if nullptr the caller owns the object
+         * @param [in] options what is kept from comments
+         * @return JiraIssue* new object of JiraIssue with fields values from json
+         */
+        static JiraIssue* fromJSON(const nlohmann::json& json_data, JiraArena* arena = nullptr, const ParseOptions& options = ParseOptions());
+        /**
+         * @brief Creates JiraIssue objects from an array of issues
+         * 
+         * Elements are split into tasks of `options.issues_per_task` issues which run
+         * on the executor, the calling thread maps issues too. Issues keep the order
+         * of the array.
+         * 
+         * @param [in] json_issues parsed array of issues
+         * @param [in] arena owner of the new objects, if nullptr the caller owns the objects
+         * @param [in] options what is kept from comments and size of tasks
+         * @param [in] executor threads for mapping, nullptr to map on the calling thread
+         * @return std::vector<JiraIssue*> new objects in the order of the array
+         */
+        static std::vector<JiraIssue*> fromJSONArray(const nlohmann::json& json_issues, JiraArena* arena,
+            const ParseOptions& options = ParseOptions(), Executor* executor = nullptr);
+        /**
+         * @brief Parses a page of issues returned by Jira
+         * 
+         * With JsonParser::Simdjson (when available) the page is parsed by simdjson and
+         * issues are mapped straight from its document, no nlohmann::json is built.
+         * Mapping is split across the executor like in fromJSONArray(). Both parsers
+         * create equal objects.
+         * 
+         * @param [in] page body of the page
+         * @param [in] items_key name of the array with issues ("issues")
+         * @param [out] issues new objects are appended here
+         * @param [in] arena owner of the new objects, if nullptr the caller owns the objects
+         * @param [in] options parser and what is kept from comments
+         * @param [in] executor threads for mapping, nullptr to map on the calling thread
+         * @return PageEnvelope pagination fields of the page, for PageIterator
+         */
+        static PageEnvelope fromPage(const std::string& page, const std::string& items_key, std::vector<JiraIssue*>& issues,
+            JiraArena* arena, const ParseOptions& options = ParseOptions(), Executor* executor = nullptr);
+        /**
+         * @brief Check if the library is built with simdjson
+         * 
+         * @return true if JsonParser::Simdjson uses simdjson
+         */
+        static bool simdjsonAvailable();
 };
 
 
@@ -165,6 +308,16 @@ class JiraSprint {
          * @return JiraSprint* new object of JiraSprint with fields values from json
          */
         static JiraSprint* fromJSON(const std::string json_string);
+        /**
+         * @brief Creates a JiraSprint object from already parsed JSON
+         * 
+         * Same as the string version, but skips parsing of the JSON text.
+         * 
+         * @param [in] json_data parsed JSON representation of the sprint
+         * @param [in] arena owner of the new object, if nullptr the caller owns the object
+         * @return JiraSprint* new object of JiraSprint with fields values from json
+         */
+        static JiraSprint* fromJSON(const nlohmann::json& json_data, JiraArena* arena = nullptr);
 };
 
 
@@ -177,8 +330,8 @@ class PersonalResult {
         std::string sprint_id;      /** < ID of the sprint that has all issues */
         std::vector<JiraIssue*> finished;           /** < List of issues with different types completed during the sprint */
         std::vector<JiraIssue*> not_finished;       /** < List of issue with different types were not completed during the sprint */
-        std::vector<Comment> comments_written;      /** < Comment written by the user in all issues inside the sprint during the sprint */
-        int issues_reviwed;                         /** < Number of issues assigned to somebidy else but commented by the user during the sprint */
+        std::vector<const Comment*> comments_written;   /** < Comment written by the user in all issues inside the sprint during the sprint, owned by issues */
+        int issues_reviwed = 0;                         /** < Number of issues assigned to somebidy else but commented by the user during the sprint */
         
         /**
          * @brief Construct a new Personal Result object
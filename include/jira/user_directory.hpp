@@ -0,0 +1,114 @@
+/**
+ * @file user_directory.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Directory of people resolved by names, kept between sessions
+ * @version 0.1
+ * @date 2020-07-13
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef USER_DIRECTORY_H_
+#define USER_DIRECTORY_H_
+
+#include <jira/types.hpp>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Name -> account of people which were already found in Jira
+ *
+ * Names are the ones passed to JiraClient::getPerson() ("name surname" or just
+ * "surname"). Every entry remembers when it was resolved and is fresh for `ttl`
+ * seconds. Stale entries are not forgotten: their account ids are still known
+ * and can be checked with a cheaper exact request. The directory can be saved to
+ * a file and loaded in the next session. All methods are thread-safe.
+ */
+class UserDirectory {
+    public:
+        /**
+         * @brief Account found for a name
+         */
+        struct Entry {
+            std::string account_id;     /** < Account id of the person */
+            std::string display_name;   /** < Name shown by Jira */
+            time_t resolved_at = 0;     /** < When the name was resolved */
+        };
+
+        /**
+         * @brief Set how long entries stay fresh
+         *
+         * @param [in] seconds lifetime of an entry, 0 makes all entries stale
+         */
+        void setTtl(double seconds);
+
+        /**
+         * @brief Find an entry by name
+         *
+         * @param [in] name name used for the search
+         * @param [out] entry the entry, set only if the name is known
+         * @return true if the name is known, fresh or not
+         */
+        bool find(const std::string& name, Entry& entry) const;
+
+        /**
+         * @brief Check that the entry was resolved less than `ttl` seconds ago
+         *
+         * @param [in] entry the entry
+         * @param [in] now current time
+         * @return true if the entry can be used without requests
+         */
+        bool isFresh(const Entry& entry, time_t now) const;
+
+        /**
+         * @brief Add or replace an entry
+         *
+         * @param [in] name name used for the search
+         * @param [in] user found user
+         * @param [in] resolved_at when the user was found
+         */
+        void add(const std::string& name, const JiraUser& user, time_t resolved_at);
+
+        /**
+         * @brief Forget a name, e.g. when its account is gone
+         *
+         * @param [in] name name used for the search
+         */
+        void remove(const std::string& name);
+
+        /**
+         * @brief Get number of known names
+         *
+         * @return size_t number of entries
+         */
+        size_t size() const;
+
+        /**
+         * @brief Load entries saved by save(), known entries are replaced
+         *
+         * Malformed entries are skipped.
+         *
+         * @param [in] path file with the directory
+         * @return true if the file was read, false if it is missing or not a directory file
+         */
+        bool load(const std::string& path);
+
+        /**
+         * @brief Save the directory into a file
+         *
+         * @param [in] path file for the directory, replaced atomically
+         *
+         * @throws std::runtime_error Thrown if the file cannot be written.
+         */
+        void save(const std::string& path) const;
+
+    private:
+        std::unordered_map<std::string, Entry> entries;
+        double ttl = 7 * 24 * 3600;
+        mutable std::mutex mutex;
+};
+
+#endif // USER_DIRECTORY_H_
@@ -0,0 +1,158 @@
+/**
+ * @file daemon.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Long-running service which keeps sprint results warm and serves reports
+ * @version 0.1
+ * @date 2020-07-08
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef DAEMON_H_
+#define DAEMON_H_
+
+#include <jira/jira_client.hpp>
+#include <jira/local_server.hpp>
+#include <report/report.hpp>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief What the ReportDaemon reports and how often it is refreshed
+ *
+ * Sprints are selected by names when `sprint_names` is not empty, otherwise by
+ * dates. A far `end_date` keeps new sprints coming into the report.
+ */
+struct DaemonOptions {
+    std::vector<std::string> boards;        /** < Names of reported boards */
+    std::vector<std::string> people;        /** < Names of reported people, see JiraClient::getPerson() */
+    bool filter_people = false;             /** < Download only issues of the people, see JiraClient::setTrackedPeople() */
+    std::set<std::string> sprint_names;     /** < Sprints selected by names */
+    std::string start_date;                 /** < Sprints started after this date */
+    std::string end_date;                   /** < Sprints ended before this date */
+    double refresh_seconds = 300;           /** < Pause between background refreshes */
+    size_t recycle_after = 100;             /** < Refreshes before the client is replaced to free its objects */
+};
+
+/**
+ * @brief Keeps report rows of configured boards in memory and refreshes them
+ *
+ * The first refresh resolves people and downloads all selected sprints. Later
+ * refreshes ask Jira for active and future sprints only: rows of closed sprints
+ * are computed once and kept, open sprints are downloaded and counted again.
+ * Queries are answered from memory.
+ *
+ * Every object returned by a JiraClient lives until the client is destroyed, so
+ * the daemon makes a new client with the factory after `recycle_after` refreshes.
+ * Kept rows don't depend on the client.
+ *
+ * If a refresh fails, the previous rows are served and the error is reported by
+ * the `/health` endpoint. All methods are thread-safe.
+ */
+class ReportDaemon {
+    public:
+        /**
+         * @brief Function which creates a configured client
+         */
+        typedef std::function<std::unique_ptr<JiraClient>()> ClientFactory;
+
+        /**
+         * @brief Construct a new Report Daemon object, nothing is requested yet
+         *
+         * @param [in] factory creates clients, called by refresh()
+         * @param [in] options reported boards, people and sprints
+         *
+         * @throws std::invalid_argument Thrown if no boards are given.
+         */
+        ReportDaemon(ClientFactory factory, const DaemonOptions options);
+
+        /**
+         * @brief Stop background refreshes
+         */
+        ~ReportDaemon();
+
+        ReportDaemon(const ReportDaemon&) = delete;
+        ReportDaemon& operator=(const ReportDaemon&) = delete;
+
+        /**
+         * @brief Download changes and recount open sprints now
+         *
+         * @throws std::exception Errors of the client, rows of the previous refresh are kept.
+         */
+        void refresh();
+
+        /**
+         * @brief Refresh in a background thread every `refresh_seconds`
+         *
+         * Errors of background refreshes are logged and kept for `/health`.
+         */
+        void start();
+
+        /**
+         * @brief Stop background refreshes and wait for the current one
+         */
+        void stop();
+
+        /**
+         * @brief Format kept rows
+         *
+         * @param [in] format output format
+         * @param [in] board name of the board, empty for all boards
+         * @return std::string the report
+         *
+         * @throws std::invalid_argument Thrown if the board is not reported.
+         */
+        std::string report(ReportFormat format, const std::string& board = "") const;
+
+        /**
+         * @brief Answer a request of LocalHttpServer
+         *
+         * - `GET /report?board=<name>&format=<csv|jsonl|markdown>` kept rows, all boards
+         *   and Markdown by default
+         * - `GET /health` time and error of the last refresh
+         * - `GET /metrics` metrics of the client in Prometheus format
+         *
+         * @param [in] request the request
+         * @return HttpResponse the response
+         */
+        HttpResponse handle(const HttpRequest& request) const;
+
+    private:
+        struct SprintRows {
+            bool closed = false;
+            time_t start_date = {};
+            std::vector<ReportRow> rows;
+        };
+        typedef std::map<int, SprintRows> BoardRows;    /** < sprint id -> rows */
+
+        void runRefreshes();
+
+        ClientFactory factory;
+        DaemonOptions options;
+        std::unique_ptr<JiraClient> client;
+        std::vector<JiraUser*> people;
+        size_t refreshes = 0;
+        std::mutex refresh_mutex;                       /** < one refresh at a time, guards client and people */
+
+        mutable std::mutex mutex;                       /** < guards everything below */
+        std::map<std::string, BoardRows> boards;
+        std::string metrics;
+        time_t refreshed_at = 0;
+        std::string last_error;
+
+        std::thread refresher;
+        std::mutex stop_mutex;
+        std::condition_variable stop_requested;
+        bool stopping = false;
+};
+
+#endif // DAEMON_H_
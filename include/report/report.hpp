@@ -0,0 +1,164 @@
+/**
+ * @file report.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Streaming reports of sprint results in CSV, JSON Lines and Markdown
+ * @version 0.1
+ * @date 2020-07-06
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef REPORT_H_
+#define REPORT_H_
+
+#include <jira/columns.hpp>
+#include <jira/types.hpp>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Results of one person in one sprint, one line of a report
+ */
+struct ReportRow {
+    int board_id = 0;               /** < ID of the board of the sprint */
+    int sprint_id = 0;              /** < ID of the sprint */
+    std::string sprint;             /** < Name of the sprint */
+    time_t start_date = {};         /** < Start of the sprint */
+    time_t end_date = {};           /** < End of the sprint */
+    std::string account_id;         /** < Account id of the person */
+    std::string person;             /** < Display name of the person */
+    PersonTally finished;           /** < Issues finished before the end of the sprint */
+    size_t not_finished = 0;        /** < Assigned issues which were not finished */
+    size_t comments = 0;            /** < Comments written during the sprint */
+    size_t comment_lines = 0;       /** < Non-empty lines of these comments */
+    size_t comment_chars = 0;       /** < Characters (UTF-8 code points, not bytes) of these comments */
+    int reviewed = 0;               /** < Issues of other people commented during the sprint */
+
+    /**
+     * @brief Build rows of all people in the sprint
+     *
+     * @param [in] sprint the sprint
+     * @param [in] people people in the same order as results and tallies
+     * @param [in] results results from JiraClient::getSprintResults()
+     * @param [in] tallies totals from SprintColumns::countFinished()
+     * @return std::vector<ReportRow> a row for each person
+     */
+    static std::vector<ReportRow> fromSprint(const JiraSprint& sprint, const std::vector<JiraUser*>& people,
+        const std::vector<PersonalResult*>& results, const std::vector<PersonTally>& tallies);
+};
+
+/**
+ * @brief Output format of a report
+ */
+enum class ReportFormat {
+    Csv,        /** < Header line and one comma-separated line per row (RFC 4180 quoting) */
+    JsonLines,  /** < One JSON object per line */
+    Markdown    /** < A heading and a table per sprint */
+};
+
+/**
+ * @brief Writes report rows as soon as they are produced
+ *
+ * Rows are formatted into an internal buffer which is written to the stream when
+ * it is full, so a report of any size needs memory for one buffer only. Rows of
+ * one sprint are expected to come together (Markdown starts a new table when the
+ * sprint changes). The stream must outlive the writer.
+ *
+ * The writer is thread-safe: sprints of different boards can be written from
+ * different threads, rows written by one writeSprint() call stay together.
+ */
+class ReportWriter {
+    public:
+        /**
+         * @brief Create a writer of the given format
+         *
+         * @param [in] format output format
+         * @param [in] out where the report is written
+         * @param [in] buffer_size bytes collected before they are written to the stream
+         * @return std::unique_ptr<ReportWriter> the writer
+         */
+        static std::unique_ptr<ReportWriter> create(ReportFormat format, std::ostream& out, size_t buffer_size = 64 * 1024);
+
+        /**
+         * @brief Get the format by its name
+         *
+         * @param [in] name "csv", "jsonl" (or "json") or "markdown" (or "md")
+         * @return ReportFormat the format
+         *
+         * @throws std::invalid_argument Thrown if the name is unknown.
+         */
+        static ReportFormat formatFromName(const std::string& name);
+
+        /**
+         * @brief Write out the buffer, see finish()
+         */
+        virtual ~ReportWriter();
+
+        ReportWriter(const ReportWriter&) = delete;
+        ReportWriter& operator=(const ReportWriter&) = delete;
+
+        /**
+         * @brief Add one row to the report
+         *
+         * @param [in] row results of a person in a sprint
+         */
+        void write(const ReportRow& row);
+
+        /**
+         * @brief Add rows of all people in the sprint
+         *
+         * @param [in] sprint the sprint
+         * @param [in] people people in the same order as results and tallies
+         * @param [in] results results from JiraClient::getSprintResults()
+         * @param [in] tallies totals from SprintColumns::countFinished()
+         */
+        void writeSprint(const JiraSprint& sprint, const std::vector<JiraUser*>& people,
+            const std::vector<PersonalResult*>& results, const std::vector<PersonTally>& tallies);
+
+        /**
+         * @brief Add rows which stay together in the report
+         *
+         * @param [in] rows rows of one sprint
+         */
+        void writeRows(const std::vector<ReportRow>& rows);
+
+        /**
+         * @brief Write the buffered part of the report to the stream and flush it
+         */
+        void finish();
+
+        /**
+         * @brief Get number of written rows
+         *
+         * @return size_t rows since the writer was created
+         */
+        size_t rows() const;
+
+    protected:
+        ReportWriter(std::ostream& out, size_t buffer_size);
+
+        /**
+         * @brief Format the row with append()
+         */
+        virtual void format(const ReportRow& row) = 0;
+
+        /**
+         * @brief Append formatted text, the buffer is written out when it is full
+         */
+        void append(const std::string& text);
+
+    private:
+        void writeRow(const ReportRow& row);
+
+        mutable std::mutex mutex;
+        size_t written = 0;
+        std::ostream& out;
+        std::string buffer;
+        size_t buffer_size;
+};
+
+#endif // REPORT_H_
@@ -20,20 +20,43 @@
 class Utils {
     public:
         /**
-         * @brief Parse timestamp from defined format
+         * @brief Parse timestamp in ISO-8601 format used by Jira
          * 
-         * @param timestamp time in format %Y-%m-%dT%H:%M:%S
-         * @return time_t parsed c++ time structure 
+         * Accepts `%Y-%m-%d` optionally followed by `T%H:%M[:%S][.fff]` and an UTC offset
+         * (`Z`, `+0300` or `+03:00`). Fractional seconds are dropped. Timestamps without
+         * an offset are treated as local time. The parser does not allocate and is thread-safe.
+         * 
+         * @param timestamp time in format %Y-%m-%dT%H:%M:%S.fff+zzzz
+         * @return time_t parsed time, (time_t)(-1) if timestamp has incorrect format
+         */
+        static time_t parseTimestapm(const std::string& timestamp);
+
+        /**
+         * @brief Parse timestamp in ISO-8601 format used by Jira
+         * 
+         * @param timestamp pointer to the first character of the timestamp, it doesn't need to be null-terminated
+         * @param length number of characters in the timestamp
+         * @return time_t parsed time, (time_t)(-1) if timestamp has incorrect format
          */
-        static time_t parseTimestapm(const std::string timestamp);
+        static time_t parseTimestapm(const char* timestamp, size_t length);
 
         /**
          * @brief Converts time_t structure to a string
          * 
          * @param time time_t presentation of time
-         * @return std::string string presentation in format %Y-%m-%dT%H:%M:%S
+         * @return std::string string presentation in format %Y-%m-%d %H:%M:%S (local time)
          */
         static std::string timeToString(const time_t time);
+
+        /**
+         * @brief Writes time into the provided buffer, thread-safe
+         * 
+         * @param time time_t presentation of time
+         * @param buffer where to put the string, 20 characters are enough
+         * @param size size of the buffer
+         * @return size_t number of written characters without the null terminator, 0 if buffer is too small
+         */
+        static size_t timeToString(const time_t time, char* buffer, size_t size);
 };
 
 #endif // UTILS_H_
@@ -0,0 +1,83 @@
+#include "jira/aggregator.hpp"
+#include "logging.hpp"
+
+auto aggregator_logger = makeLogger("Jira Aggregator");
+
+SprintAggregator::SprintAggregator(const std::vector<JiraUser*>& people) {
+    for (auto person : people) {
+        AccountHandle handle = person->handle != NO_ACCOUNT ? person->handle : AccountIndex::intern(person->id);
+        if (index.size() <= handle) {
+            index.resize(handle + 1, -1);
+        }
+        // a person listed twice is counted once, the result is copied to every position
+        if (index[handle] < 0) {
+            index[handle] = static_cast<int>(this->people.size());
+            this->people.push_back(person);
+        }
+        slots.push_back(index[handle]);
+    }
+}
+
+int SprintAggregator::position(AccountHandle handle) const {
+    return handle < index.size() ? index[handle] : -1;
+}
+
+std::vector<PersonalResult*> SprintAggregator::aggregate(const JiraSprint& sprint, JiraArena* arena) const {
+    std::vector<PersonalResult*> results;
+    results.reserve(people.size());
+    for (auto person : people) {
+        PersonalResult* result = arena != nullptr ? arena->results.create() : new PersonalResult();
+        result->user_id = person->id;
+        result->sprint_id = std::to_string(sprint.id);
+        results.push_back(result);
+    }
+    // number of the last issue (starting from 1) counted as reviewed for each person
+    std::vector<size_t> reviewed_in(people.size(), 0);
+    size_t issue_number = 0;
+    for (auto issue : sprint.issues) {
+        issue_number++;
+        for (const auto& comment : issue->comments) {
+            if (difftime(comment.published_date, sprint.end_date) >= 0 || difftime(comment.published_date, sprint.start_date) <= 0) {
+                continue;
+            }
+            int author = position(comment.author);
+            if (author < 0) {
+                continue;
+            }
+            JIRA_LOG_DEBUG(aggregator_logger, "Found comment for {} with text: {}", people[author]->name, comment.preview);
+            results[author]->comments_written.push_back(&comment);
+            if (issue->assignee != comment.author && reviewed_in[author] != issue_number) {
+                JIRA_LOG_DEBUG(aggregator_logger, "Found review for {} in issue {}", people[author]->name, issue->key);
+                reviewed_in[author] = issue_number;
+                results[author]->issues_reviwed++;
+            }
+        }
+        int assignee = position(issue->assignee);
+        if (assignee < 0) {
+            continue;
+        }
+        PersonalResult* result = results[assignee];
+        if (issue->resolved && (difftime(issue->resolution_date, sprint.end_date) < 0)) {
+            result->finished.push_back(issue);
+        } else {
+            result->not_finished.push_back(issue);
+        }
+    }
+    if (slots.size() == people.size()) {
+        return results;
+    }
+    std::vector<PersonalResult*> ordered;
+    std::vector<bool> taken(people.size(), false);
+    ordered.reserve(slots.size());
+    for (int slot : slots) {
+        if (!taken[slot]) {
+            taken[slot] = true;
+            ordered.push_back(results[slot]);
+            continue;
+        }
+        PersonalResult* copy = arena != nullptr ? arena->results.create() : new PersonalResult();
+        *copy = *results[slot];
+        ordered.push_back(copy);
+    }
+    return ordered;
+}
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+#include "jira/board_index.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    // makes names of temporary files unique between threads of one process
+    std::atomic<unsigned> temporary_files(0);
+
+    bool isBoardId(const std::string& key) {
+        return !key.empty() && key.size() < 10 && std::all_of(key.begin(), key.end(), [](unsigned char c) { return std::isdigit(c); });
+    }
+
+    // fields written by BoardIndex::save() with their types
+    bool isSprint(const json& value) {
+        if (!value.is_object()) {
+            return false;
+        }
+        for (const char* key : {"id", "board_id", "start_date", "end_date", "complete_date"}) {
+            auto found = value.find(key);
+            if (found == value.end() || !found->is_number_integer()) {
+                return false;
+            }
+        }
+        auto name = value.find("name");
+        auto closed = value.find("closed");
+        return name != value.end() && name->is_string() && closed != value.end() && closed->is_boolean();
+    }
+}
+
+int BoardIndex::boardId(const std::string& board_name) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto found = boards.find(board_name);
+    return found != boards.end() ? found->second : -1;
+}
+
+void BoardIndex::setBoards(const std::map<std::string, int>& boards) {
+    std::lock_guard<std::mutex> guard(mutex);
+    this->boards.clear();
+    this->boards.insert(boards.begin(), boards.end());
+}
+
+bool BoardIndex::isFresh(int board_id) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto found = board_sprints.find(board_id);
+    return found != board_sprints.end() && found->second.fresh;
+}
+
+std::vector<JiraSprint> BoardIndex::sprints(int board_id) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto found = board_sprints.find(board_id);
+    return found != board_sprints.end() ? found->second.sprints : std::vector<JiraSprint>();
+}
+
+void BoardIndex::rebuild(BoardSprints& board) {
+    std::stable_sort(board.sprints.begin(), board.sprints.end(), [](const JiraSprint& left, const JiraSprint& right) {
+        return left.start_date < right.start_date;
+    });
+    board.by_name.clear();
+    for (size_t i = 0; i < board.sprints.size(); i++) {
+        board.sprints[i].issues.clear();
+        board.by_name.insert({board.sprints[i].name, i});
+    }
+}
+
+void BoardIndex::setSprints(int board_id, std::vector<JiraSprint> sprints) {
+    std::lock_guard<std::mutex> guard(mutex);
+    BoardSprints& board = board_sprints[board_id];
+    board.sprints = std::move(sprints);
+    board.fresh = true;
+    rebuild(board);
+}
+
+void BoardIndex::expire() {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto& board : board_sprints) {
+        board.second.fresh = false;
+    }
+}
+
+std::vector<JiraSprint> BoardIndex::sprintsByNames(int board_id, const std::set<std::string>& names) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    std::vector<JiraSprint> selected;
+    auto board = board_sprints.find(board_id);
+    if (board == board_sprints.end()) {
+        return selected;
+    }
+    std::vector<size_t> positions;
+    for (const auto& name : names) {
+        auto found = board->second.by_name.find(name);
+        if (found != board->second.by_name.end()) {
+            positions.push_back(found->second);
+        }
+    }
+    std::sort(positions.begin(), positions.end());
+    for (auto position : positions) {
+        selected.push_back(board->second.sprints[position]);
+    }
+    return selected;
+}
+
+std::vector<JiraSprint> BoardIndex::sprintsBetween(int board_id, time_t start, time_t end) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    std::vector<JiraSprint> selected;
+    auto board = board_sprints.find(board_id);
+    if (board == board_sprints.end()) {
+        return selected;
+    }
+    const std::vector<JiraSprint>& sprints = board->second.sprints;
+    // first sprint that started after the beginning of the interval
+    auto first = std::upper_bound(sprints.begin(), sprints.end(), start, [](time_t time, const JiraSprint& sprint) {
+        return time < sprint.start_date;
+    });
+    for (auto sprint = first; sprint != sprints.end() && sprint->start_date < end; ++sprint) {
+        if (difftime(sprint->complete_date, end) < 0) {
+            selected.push_back(*sprint);
+        }
+    }
+    return selected;
+}
+
+bool BoardIndex::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    json data = json::parse(file, nullptr, false);
+    if (data.is_discarded() || !data.is_object()) {
+        return false;
+    }
+    auto all_boards = data.find("boards");
+    auto all_sprints = data.find("sprints");
+    if ((all_boards != data.end() && !all_boards->is_object()) || (all_sprints != data.end() && !all_sprints->is_object())) {
+        return false;
+    }
+    // damaged entries are skipped, their boards and sprints are requested from Jira again
+    std::unordered_map<std::string, int> loaded_boards;
+    if (all_boards != data.end()) {
+        for (const auto& board : all_boards->items()) {
+            if (board.value().is_number_integer()) {
+                loaded_boards[board.key()] = board.value().get<int>();
+            }
+        }
+    }
+    std::unordered_map<int, std::vector<JiraSprint>> loaded_sprints;
+    if (all_sprints != data.end()) {
+        for (const auto& board : all_sprints->items()) {
+            const json& list = board.value();
+            // a list is taken whole or not at all, counts of known sprints are used to page the next requests
+            if (!isBoardId(board.key()) || !list.is_array() || !std::all_of(list.begin(), list.end(), isSprint)) {
+                continue;
+            }
+            std::vector<JiraSprint>& sprints = loaded_sprints[std::stoi(board.key())];
+            for (const auto& json_sprint : list) {
+                JiraSprint sprint;
+                sprint.id = json_sprint["id"].get<int>();
+                sprint.board_id = json_sprint["board_id"].get<int>();
+                sprint.name = json_sprint["name"].get<std::string>();
+                sprint.start_date = json_sprint["start_date"].get<time_t>();
+                sprint.end_date = json_sprint["end_date"].get<time_t>();
+                sprint.complete_date = json_sprint["complete_date"].get<time_t>();
+                sprint.is_closed = json_sprint["closed"].get<bool>();
+                sprints.push_back(sprint);
+            }
+        }
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    for (const auto& board : loaded_boards) {
+        boards[board.first] = board.second;
+    }
+    for (auto& board : loaded_sprints) {
+        BoardSprints& entry = board_sprints[board.first];
+        entry.sprints = std::move(board.second);
+        entry.fresh = false;
+        rebuild(entry);
+    }
+    return true;
+}
+
+void BoardIndex::save(const std::string& path) const {
+    // the lock is kept while writing, so concurrent saves don't share the temporary file
+    std::lock_guard<std::mutex> guard(mutex);
+    json data = {{"boards", json::object()}, {"sprints", json::object()}};
+    for (const auto& board : boards) {
+        data["boards"][board.first] = board.second;
+    }
+    for (const auto& board : board_sprints) {
+        json sprints = json::array();
+        for (const auto& sprint : board.second.sprints) {
+            sprints.push_back({
+                {"id", sprint.id},
+                {"board_id", sprint.board_id},
+                {"name", sprint.name},
+                {"start_date", sprint.start_date},
+                {"end_date", sprint.end_date},
+                {"complete_date", sprint.complete_date},
+                {"closed", sprint.is_closed}});
+        }
+        data["sprints"][std::to_string(board.first)] = std::move(sprints);
+    }
+    std::string temporary = path + "." + std::to_string(getpid()) + "-" + std::to_string(temporary_files++) + ".tmp";
+    {
+        std::ofstream file(temporary);
+        file << data.dump();
+        if (!file.good()) {
+            throw std::runtime_error("Cannot write index file: " + temporary);
+        }
+    }
+    std::rename(temporary.c_str(), path.c_str());
+}
@@ -0,0 +1,109 @@
+#include "jira/columns.hpp"
+
+#include <algorithm>
+
+namespace {
+    // rows are processed by blocks, temporary arrays of a block stay in L1 cache
+    const size_t BLOCK_SIZE = 1024;
+
+    // 1 if story points of the category are counted
+    const int32_t COUNT_STORY_POINTS[CATEGORIES_COUNT] = {1, 1, 1, 0, 0};
+}
+
+IssueCategory SprintColumns::categorize(IssueType type) {
+    switch (type) {
+    case IssueType::Subtask:
+        return CountedSubtask;
+    case IssueType::Task:
+    case IssueType::Enabler:
+    case IssueType::Debt:
+        return CountedIssue;
+    case IssueType::Bug:
+        return CountedBug;
+    case IssueType::Story:
+        return CountedStory;
+    default:
+        return CountedOther;
+    }
+}
+
+SprintColumns SprintColumns::fromSprint(const JiraSprint& sprint) {
+    SprintColumns columns;
+    columns.category.reserve(sprint.issues.size());
+    columns.story_points.reserve(sprint.issues.size());
+    columns.assignee.reserve(sprint.issues.size());
+    columns.resolved.reserve(sprint.issues.size());
+    columns.resolution_date.reserve(sprint.issues.size());
+    for (auto issue : sprint.issues) {
+        columns.append(*issue);
+    }
+    return columns;
+}
+
+void SprintColumns::append(const JiraIssue& issue) {
+    category.push_back(categorize(issue.type));
+    story_points.push_back(issue.story_points);
+    assignee.push_back(issue.assignee);
+    resolved.push_back(issue.resolved ? 1 : 0);
+    resolution_date.push_back(static_cast<int64_t>(issue.resolution_date));
+}
+
+size_t SprintColumns::size() const {
+    return category.size();
+}
+
+std::vector<PersonTally> SprintColumns::countFinished(const std::vector<AccountHandle>& people, time_t sprint_end) const {
+    // account handle -> row of the tally table; untracked people go to the extra last row
+    const int32_t untracked = static_cast<int32_t>(people.size());
+    AccountHandle max_handle = 0;
+    for (auto handle : people) {
+        max_handle = std::max(max_handle, handle);
+    }
+    for (auto handle : assignee) {
+        max_handle = std::max(max_handle, handle);
+    }
+    std::vector<int32_t> slot_of(max_handle + 1, untracked);
+    // a person listed twice is counted in the row of the first position, the row is copied to the others
+    for (size_t i = people.size(); i-- > 0;) {
+        slot_of[people[i]] = static_cast<int32_t>(i);
+    }
+    slot_of[NO_ACCOUNT] = untracked;
+
+    std::vector<int32_t> counts((people.size() + 1) * CATEGORIES_COUNT, 0);
+    std::vector<int32_t> points(people.size() + 1, 0);
+    const int64_t end = static_cast<int64_t>(sprint_end);
+    int32_t slots[BLOCK_SIZE];
+    for (size_t begin = 0; begin < size(); begin += BLOCK_SIZE) {
+        const size_t length = std::min(BLOCK_SIZE, size() - begin);
+        const uint8_t* is_resolved = resolved.data() + begin;
+        const int64_t* resolved_at = resolution_date.data() + begin;
+        const AccountHandle* owner = assignee.data() + begin;
+        // branch-free pass: not finished issues are sent to the untracked row
+        for (size_t i = 0; i < length; i++) {
+            int32_t finished = is_resolved[i] & (resolved_at[i] < end);
+            int32_t slot = slot_of[owner[i]];
+            slots[i] = finished * slot + (1 - finished) * untracked;
+        }
+        const uint8_t* categories = category.data() + begin;
+        const int32_t* estimations = story_points.data() + begin;
+        for (size_t i = 0; i < length; i++) {
+            counts[slots[i] * CATEGORIES_COUNT + categories[i]] += 1;
+            points[slots[i]] += estimations[i] * COUNT_STORY_POINTS[categories[i]];
+        }
+    }
+
+    std::vector<PersonTally> tallies(people.size());
+    for (size_t i = 0; i < people.size(); i++) {
+        const int32_t slot = slot_of[people[i]];
+        if (slot == untracked) {
+            continue;
+        }
+        const int32_t* row = counts.data() + slot * CATEGORIES_COUNT;
+        tallies[i].subtasks = row[CountedSubtask];
+        tallies[i].issues = row[CountedIssue] + row[CountedStory];
+        tallies[i].bugs = row[CountedBug];
+        tallies[i].others = row[CountedOther];
+        tallies[i].story_points = points[slot];
+    }
+    return tallies;
+}
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+#include "report/daemon.hpp"
+#include "utils.hpp"
+#include "logging.hpp"
+
+using json = nlohmann::json;
+
+auto daemon_logger = makeLogger("Report Daemon");
+
+namespace {
+    HttpResponse reply(long status_code, const std::string& text, const std::string& content_type) {
+        HttpResponse response;
+        response.status_code = status_code;
+        response.text = text;
+        response.headers["content-type"] = content_type;
+        return response;
+    }
+
+    std::string contentType(ReportFormat format) {
+        switch (format) {
+            case ReportFormat::Csv:
+                return "text/csv; charset=utf-8";
+            case ReportFormat::JsonLines:
+                return "application/x-ndjson";
+            case ReportFormat::Markdown:
+                return "text/markdown; charset=utf-8";
+        }
+        return "text/plain";
+    }
+}
+
+ReportDaemon::ReportDaemon(ClientFactory factory, const DaemonOptions options) {
+    if (options.boards.empty()) {
+        throw std::invalid_argument("Daemon needs at least one board");
+    }
+    this->factory = factory;
+    this->options = options;
+}
+
+ReportDaemon::~ReportDaemon() {
+    stop();
+}
+
+void ReportDaemon::refresh() {
+    std::lock_guard<std::mutex> guard(refresh_mutex);
+    auto refresh_start = std::chrono::steady_clock::now();
+    try {
+        if (!client || (options.recycle_after > 0 && refreshes > 0 && refreshes % options.recycle_after == 0)) {
+            // the old client is destroyed first, kept rows don't point to its objects
+            client.reset();
+            people.clear();
+            // taken only when people are resolved, otherwise the next refresh starts over
+            std::unique_ptr<JiraClient> created = factory();
+            std::vector<JiraUser*> resolved = created->getPersons(options.people);
+            if (options.filter_people) {
+                created->setTrackedPeople(resolved);
+            }
+            client = std::move(created);
+            people = resolved;
+            daemon_logger->info("New client is created, {} people are resolved", people.size());
+        } else {
+            client->expireSprintLists();
+        }
+        refreshes++;
+        std::vector<AccountHandle> handles;
+        for (auto person : people) {
+            handles.push_back(person->handle);
+        }
+        std::map<std::string, BoardRows> previous;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            previous = boards;
+        }
+        // closed sprints keep their rows, others are downloaded and counted again
+        std::map<std::string, BoardRows> updated;
+        std::vector<JiraSprint*> changed;
+        std::vector<std::string> changed_boards;
+        for (const auto& board : options.boards) {
+            std::vector<JiraSprint*> sprints = options.sprint_names.empty()
+                ? client->findSprints(board, options.start_date, options.end_date)
+                : client->findSprints(board, options.sprint_names);
+            BoardRows& rows = updated[board];
+            const BoardRows& known = previous[board];
+            for (auto sprint : sprints) {
+                auto found = known.find(sprint->id);
+                if (sprint->is_closed && found != known.end() && found->second.closed) {
+                    rows.insert(*found);
+                } else {
+                    changed.push_back(sprint);
+                    changed_boards.push_back(board);
+                }
+            }
+        }
+        client->loadIssues(changed);
+        for (size_t i = 0; i < changed.size(); i++) {
+            const JiraSprint& sprint = *changed[i];
+            SprintRows& entry = updated[changed_boards[i]][sprint.id];
+            entry.closed = sprint.is_closed;
+            entry.start_date = sprint.start_date;
+            entry.rows = ReportRow::fromSprint(sprint, people, client->getSprintResults(people, sprint),
+                SprintColumns::fromSprint(sprint).countFinished(handles, sprint.end_date));
+        }
+        std::string metrics_text = client->getMetrics().toPrometheus();
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            boards.swap(updated);
+            metrics.swap(metrics_text);
+            refreshed_at = time(nullptr);
+            last_error.clear();
+        }
+        daemon_logger->info("Refreshed {} boards in {:.2f} s, {} sprints were counted again", options.boards.size(),
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - refresh_start).count(), changed.size());
+    } catch (const std::exception& error) {
+        std::lock_guard<std::mutex> guard(mutex);
+        last_error = error.what();
+        throw;
+    }
+}
+
+void ReportDaemon::start() {
+    std::lock_guard<std::mutex> guard(stop_mutex);
+    if (refresher.joinable()) {
+        return;
+    }
+    stopping = false;
+    refresher = std::thread(&ReportDaemon::runRefreshes, this);
+}
+
+void ReportDaemon::stop() {
+    {
+        std::lock_guard<std::mutex> guard(stop_mutex);
+        stopping = true;
+    }
+    stop_requested.notify_all();
+    if (refresher.joinable()) {
+        refresher.join();
+    }
+}
+
+void ReportDaemon::runRefreshes() {
+    auto pause = std::chrono::duration<double>(options.refresh_seconds);
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(stop_mutex);
+            if (stop_requested.wait_for(lock, pause, [this]() { return stopping; })) {
+                return;
+            }
+        }
+        try {
+            refresh();
+        } catch (const std::exception& error) {
+            daemon_logger->error("Refresh failed, previous results are served: {}", error.what());
+        }
+    }
+}
+
+std::string ReportDaemon::report(ReportFormat format, const std::string& board) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!board.empty() && boards.find(board) == boards.end()) {
+        throw std::invalid_argument("Board is not reported: " + board);
+    }
+    std::vector<const SprintRows*> sprints;
+    for (const auto& entry : boards) {
+        if (board.empty() || entry.first == board) {
+            for (const auto& sprint : entry.second) {
+                sprints.push_back(&sprint.second);
+            }
+        }
+    }
+    std::stable_sort(sprints.begin(), sprints.end(), [](const SprintRows* left, const SprintRows* right) {
+        return left->start_date < right->start_date;
+    });
+    std::ostringstream out;
+    {
+        std::unique_ptr<ReportWriter> writer = ReportWriter::create(format, out);
+        for (auto sprint : sprints) {
+            writer->writeRows(sprint->rows);
+        }
+    }
+    return out.str();
+}
+
+HttpResponse ReportDaemon::handle(const HttpRequest& request) const {
+    if (request.method != "GET") {
+        return reply(405, "{\"error\":\"Only GET is supported\"}", "application/json");
+    }
+    if (request.path == "/report") {
+        auto param = [&request](const std::string& name, const std::string& fallback) {
+            auto found = request.params.find(name);
+            return found != request.params.end() ? found->second : fallback;
+        };
+        try {
+            ReportFormat format = ReportWriter::formatFromName(param("format", "markdown"));
+            return reply(200, report(format, param("board", "")), contentType(format));
+        } catch (const std::invalid_argument& error) {
+            return reply(400, json({{"error", error.what()}}).dump(), "application/json");
+        }
+    }
+    if (request.path == "/health") {
+        std::lock_guard<std::mutex> guard(mutex);
+        bool ready = refreshed_at != 0;
+        json health = {
+            {"status", !last_error.empty() ? "error" : ready ? "ok" : "starting"},
+            {"refreshed_at", ready ? Utils::timeToString(refreshed_at) : ""},
+            {"boards", boards.size()},
+            {"error", last_error}};
+        return reply(ready ? 200 : 503, health.dump(), "application/json");
+    }
+    if (request.path == "/metrics") {
+        std::lock_guard<std::mutex> guard(mutex);
+        return reply(200, metrics, "text/plain; version=0.0.4");
+    }
+    return reply(404, "{\"error\":\"Not found\"}", "application/json");
+}
@@ -0,0 +1,116 @@
+#include <stdexcept>
+
+#include "jira/executor.hpp"
+
+namespace {
+    // executor and queue of the current thread, no executor for other threads
+    thread_local const Executor* current_executor = nullptr;
+    thread_local size_t current_queue = 0;
+}
+
+Executor::Executor(size_t threads) : pending(0) {
+    if (threads == 0) {
+        throw std::invalid_argument("Executor needs at least one thread");
+    }
+    for (size_t i = 0; i < threads; i++) {
+        queues.emplace_back(new Queue());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        this->threads.emplace_back(&Executor::run, this, i);
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+size_t Executor::size() const {
+    return threads.size();
+}
+
+void Executor::post(Task task) {
+    bool inside = current_executor == this;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        // running tasks may still submit subtasks while the executor is draining
+        if (stopping && !inside) {
+            throw std::logic_error("Executor is stopped");
+        }
+        // counted before the task is queued, so a woken thread never misses it
+        pending++;
+    }
+    Queue& queue = inside ? *queues[current_queue] : shared;
+    {
+        std::lock_guard<std::mutex> guard(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    ready.notify_one();
+}
+
+bool Executor::take(size_t index, Task& task) {
+    if (index < queues.size()) {
+        Queue& own = *queues[index];
+        std::lock_guard<std::mutex> guard(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending--;
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> guard(shared.mutex);
+        if (!shared.tasks.empty()) {
+            task = std::move(shared.tasks.front());
+            shared.tasks.pop_front();
+            pending--;
+            return true;
+        }
+    }
+    for (size_t i = 1; i <= queues.size(); i++) {
+        Queue& victim = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Executor::runPending() {
+    Task task;
+    // threads outside of the executor have no own queue
+    if (!take(current_executor == this ? current_queue : queues.size(), task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void Executor::run(size_t index) {
+    current_executor = this;
+    current_queue = index;
+    for (;;) {
+        Task task;
+        if (take(index, task)) {
+            // exceptions are caught by packaged_task and stored in the future
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this]() { return stopping || pending > 0; });
+        if (stopping && pending == 0) {
+            return;
+        }
+    }
+}
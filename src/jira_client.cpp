@@ -1,21 +1,37 @@
 #include <nlohmann/json.hpp>
-#include <cpr/cpr.h>
-#include <spdlog/spdlog.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
 
 #include "jira/jira_client.hpp"
+#include "jira/aggregator.hpp"
 #include "utils.hpp"
+#include "logging.hpp"
 
 using json = nlohmann::json;
-using namespace cpr;
 using namespace std;
 
 const std::string JIRA_API_URL = "rest/api/3";
 const std::string AGILE_API_URL = "rest/agile/1.0";
+// threads of the default executor; requests mostly wait for the network
+const size_t DEFAULT_EXECUTOR_THREADS = 8;
 
-auto client_logger = spdlog::stdout_color_mt("Jira Client");
+auto client_logger = makeLogger("Jira Client");
 
-JiraClient::JiraClient(const string base_url, const string username, const string api_token) {
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}
+
+JiraClient::JiraClient(const string base_url, const string username, const string api_token, const SessionOptions options)
+    : JiraClient(base_url, std::make_shared<CprTransport>(username, api_token, options)) {}
+
+JiraClient::JiraClient(const string base_url, std::shared_ptr<Transport> transport) {
     client_logger->set_level(spdlog::level::info);
     client_logger->set_pattern("[Jira Client] [%^%l%$] %v");
 
@@ -27,194 +43,621 @@ JiraClient::JiraClient(const string base_url, const string username, const strin
     }
     this->api_url += JIRA_API_URL;
     this->agile_url += AGILE_API_URL;
-    this->user = username;
-    this->token = api_token;
+    this->transport = transport;
+    this->scheduler = std::unique_ptr<RequestScheduler>(new RequestScheduler(*this->transport, SchedulerOptions(), &this->metrics));
+    this->executor = std::make_shared<Executor>(DEFAULT_EXECUTOR_THREADS);
     // make a test requests in order to verify connection
-    auto url = Url{this->api_url + "/myself"};
-    auto auth = Authentication(this->user, this->token);
-    auto response = Get(url, auth);
+    auto response = scheduler->get(this->api_url + "/myself");
     if (response.status_code != 200) {
         throw std::invalid_argument("Incorrect url, username or token was provided.");
     }
+    this->user = json::parse(response.text).value("displayName", std::string());
     client_logger->info("Jira Client created for: {} with url: {}", this->user, this->api_url);
 }
 
 JiraClient::~JiraClient() {}
 
 JiraUser* JiraClient::getPerson(const std::string surname) {
-    client_logger->trace("JiraClient::getPerson() called for name {}", surname);
-    auto url = Url{this->api_url + "/user/search"};
-    auto auth = Authentication(this->user, this->token);
-    auto params = Parameters({{"query", surname}});
-    auto response = Get(url, auth, params);
+    JIRA_LOG_TRACE(client_logger, "JiraClient::getPerson() called for name {}", surname);
+    JiraUser* user = findPerson(surname);
+    saveUsers();
+    return user;
+}
+
+std::vector<JiraUser*> JiraClient::getPersons(const std::vector<std::string>& surnames) {
+    JIRA_LOG_TRACE(client_logger, "JiraClient::getPersons() called for {} names", surnames.size());
+    std::vector<std::future<JiraUser*>> lookups;
+    for (const auto& surname : surnames) {
+        lookups.push_back(executor->submit([this, surname]() {
+            return findPerson(surname);
+        }));
+    }
+    std::vector<JiraUser*> found;
+    std::exception_ptr error;
+    for (auto& lookup : lookups) {
+        executor->wait(lookup);
+        try {
+            found.push_back(lookup.get());
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    // people found before the error are kept for the next session too
+    saveUsers();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return found;
+}
+
+JiraUser* JiraClient::findPerson(const std::string& surname) {
+    {
+        std::lock_guard<std::mutex> guard(people_mutex);
+        auto found = people.find(surname);
+        if (found != people.end()) {
+            return found->second;
+        }
+    }
+    UserDirectory::Entry entry;
+    if (users.find(surname, entry)) {
+        if (users.isFresh(entry, time(nullptr))) {
+            JIRA_LOG_DEBUG(client_logger, "Person {} is taken from the user directory", surname);
+            JiraUser* user = arena.users.create();
+            user->id = entry.account_id;
+            user->name = entry.display_name;
+            user->handle = AccountIndex::intern(user->id);
+            std::lock_guard<std::mutex> guard(people_mutex);
+            return people.insert({surname, user}).first->second;
+        }
+        JiraUser* user = checkPerson(surname, entry);
+        if (user != nullptr) {
+            return user;
+        }
+    }
+    return searchPerson(surname);
+}
+
+JiraUser* JiraClient::checkPerson(const std::string& surname, const UserDirectory::Entry& entry) {
+    // the account id is exact, so a known person can't become ambiguous
+    auto response = scheduler->get(this->api_url + "/user", {{"accountId", entry.account_id}});
+    if (response.status_code == 404) {
+        client_logger->info("Account of {} is not found anymore, searching by name", surname);
+        users.remove(surname);
+        users_changed = true;
+        return nullptr;
+    }
+    if (response.status_code != 200) {
+        throw std::logic_error(std::string("Get user returned incorrect code: ") + to_string(response.status_code));
+    }
+    auto mapping_start = Clock::now();
+    JiraUser* user = JiraUser::fromJSON(json::parse(response.text), &arena);
+    metrics.recordMapping("user", secondsSince(mapping_start), 1);
+    return rememberPerson(surname, user);
+}
+
+JiraUser* JiraClient::searchPerson(const std::string& surname) {
+    auto response = scheduler->get(this->api_url + "/user/search", {{"query", surname}});
     if (response.status_code != 200) {
         throw std::logic_error(std::string("Get users returned incorrect code: ") + to_string(response.status_code));
     }
     json search_result = json::parse(response.text);
     if (search_result.size() > 1) {
         std::string message = "Found more than 1 user with provided surname:";
-        for(auto user : search_result){
+        for(const auto& user : search_result){
             message.append(" -" + user.at("displayName").get<std::string>());
         }
         throw std::invalid_argument(message);
     }
     else if (search_result.size() == 0) throw std::invalid_argument("User was not found with provided surname - " + surname);
-    JiraUser* user = JiraUser::fromJSON(search_result[0].dump());
+    auto mapping_start = Clock::now();
+    JiraUser* user = JiraUser::fromJSON(search_result[0], &arena);
+    metrics.recordMapping("user", secondsSince(mapping_start), 1);
     client_logger->info("Person found for name {} with id {}", user->name, user->id);
-    return user;
+    return rememberPerson(surname, user);
+}
+
+JiraUser* JiraClient::rememberPerson(const std::string& surname, JiraUser* user) {
+    users.add(surname, *user, time(nullptr));
+    users_changed = true;
+    std::lock_guard<std::mutex> guard(people_mutex);
+    // a concurrent lookup of the same surname may have finished first
+    return people.insert({surname, user}).first->second;
+}
+
+void JiraClient::saveUsers() {
+    if (cache && users_changed.exchange(false)) {
+        users.save(cache->directory() + "/users.json");
+    }
 }
 
 std::vector<JiraSprint*> JiraClient::getSprints(const std::string board_name, std::set<std::string> sprint_names) {
-    client_logger->trace("JiraClient::getSprints() called for board {}", board_name);
-    vector<JiraSprint*> sprints;
-    // Looking for right Jira Board
-    auto url = Url{this->agile_url + "/board"};
-    auto auth = Authentication(this->user, this->token);
-    auto response = Get(url, auth);
-    if (response.status_code != 200) {
-        throw std::logic_error(std::string("Get board returned incorrect code: ") + to_string(response.status_code));
+    vector<JiraSprint*> sprints = findSprints(board_name, sprint_names);
+    fetchIssues(sprints);
+    return sprints;
+}
+
+std::vector<JiraSprint*> JiraClient::getSprints(const string board_name, const string start_date, const string end_date){
+    vector<JiraSprint*> sprints = findSprints(board_name, start_date, end_date);
+    fetchIssues(sprints);
+    return sprints;
+}
+
+std::vector<JiraSprint*> JiraClient::findSprints(const std::string board_name, std::set<std::string> sprint_names) {
+    JIRA_LOG_TRACE(client_logger, "JiraClient::findSprints() called for board {}", board_name);
+    vector<JiraSprint*> sprints = takeSprints(index.sprintsByNames(findBoard(board_name), sprint_names));
+    if (sprints.size() == 0) {
+        client_logger->warn("Are you sure that provided sprint names were correct? No sprints matches names was found.");
     }
-    // client_logger->info(response.text);
-    json all_boards = json::parse(response.text);
-    json board;
-    for (auto& element : all_boards["values"]) {
-        if (board_name.compare(element["name"].get<string>()) == 0) {
-            board = element;
+    return sprints;
+}
+
+std::vector<JiraSprint*> JiraClient::findSprints(const string board_name, const string start_date, const string end_date){
+    JIRA_LOG_TRACE(client_logger, "JiraClient::findSprints() called for board {} between {} and {}", board_name, start_date, end_date);
+    time_t request_start_date = Utils::parseTimestapm(start_date);
+    time_t request_end_date = Utils::parseTimestapm(end_date);
+    vector<JiraSprint*> sprints = takeSprints(index.sprintsBetween(findBoard(board_name), request_start_date, request_end_date));
+    if (sprints.size() == 0) {
+        client_logger->warn("Are you sure that start and end date a correct? No sprints inside period {} - {} was found.", Utils::timeToString(request_start_date), Utils::timeToString(request_end_date));
+    }
+    return sprints;
+}
+
+void JiraClient::loadIssues(const std::vector<JiraSprint*>& sprints) {
+    fetchIssues(sprints);
+}
+
+void JiraClient::expireSprintLists() {
+    index.expire();
+}
+
+std::future<JiraUser*> JiraClient::getPersonAsync(const std::string surname) {
+    return executor->submit([this, surname]() {
+        return getPerson(surname);
+    });
+}
+
+std::future<std::vector<JiraUser*>> JiraClient::getPersonsAsync(const std::vector<std::string> surnames) {
+    return executor->submit([this, surnames]() {
+        return getPersons(surnames);
+    });
+}
+
+std::future<std::vector<JiraSprint*>> JiraClient::getSprintsAsync(const std::string board_name, std::set<std::string> sprint_names) {
+    return executor->submit([this, board_name, sprint_names]() {
+        return getSprints(board_name, sprint_names);
+    });
+}
+
+std::future<std::vector<JiraSprint*>> JiraClient::getSprintsAsync(const std::string board_name, const std::string start_date, const std::string end_date) {
+    return executor->submit([this, board_name, start_date, end_date]() {
+        return getSprints(board_name, start_date, end_date);
+    });
+}
+
+int JiraClient::findBoard(const std::string& board_name) {
+    int board_id;
+    {
+        std::lock_guard<std::mutex> guard(board_mutex);
+        board_id = index.boardId(board_name);
+        if (board_id < 0) {
+            // all boards are loaded at once, again only when an unknown board is requested
+            std::map<std::string, int> boards;
+            PageIterator pages = paginate(this->agile_url + "/board", {}, "values", "board");
+            while (pages.next()) {
+                for (const auto& element : pages.items()) {
+                    boards[element.at("name").get<string>()] = element.at("id").get<int>();
+                }
+            }
+            index.setBoards(boards);
+            saveIndex();
+            board_id = index.boardId(board_name);
         }
     }
-    if (board.is_null()) {
+    if (board_id < 0) {
         throw std::logic_error(std::string("Cannot find a board with namee: ") + board_name);
     }
-    // Looking for all sprints in the Board that will fit dates
-    url = Url{this->agile_url + "/board/" + to_string(board.at("id").get<int>()) + "/sprint" };
-    response = Get(url, auth);
-    if (response.status_code != 200) {
-        throw std::logic_error(std::string("Get sprints returned incorrect code: ") + to_string(response.status_code));
-    }
-    json all_sprints = json::parse(response.text);
-    for (auto& element : all_sprints["values"]) {
-        JiraSprint* sprint = JiraSprint::fromJSON(element.dump());
-        // filter sprint by date
-        if (sprint_names.find(sprint->name) != sprint_names.end()) {
-            client_logger->info("Found sprint: {}\n--Started at: {}\n--Ended at: {}", sprint->name, Utils::timeToString(sprint->start_date), Utils::timeToString(sprint->end_date));
-            client_logger->info("Taking issues for the sprint ...");
-            auto url = Url{this->agile_url + "/board/" + to_string(sprint->board_id) +"/sprint/" +  to_string(sprint->id) + "/issue"};
-            auto auth = Authentication(this->user, this->token);
-            auto params = Parameters({{"maxResults", MAX_ISSUES_IN_REQUEST}});
-            auto response = Get(url, auth, params);
-            if (response.status_code != 200) {
-                throw std::logic_error(std::string("Get users returned incorrect code: ") + to_string(response.status_code));
-            }
-            json search_result = json::parse(response.text);
-            for(auto json_issue : search_result["issues"]) {
-                JiraIssue* issue = JiraIssue::fromJSON(json_issue.dump());
-                client_logger->debug("Found issue {}", issue->key);
-                sprint->issues.push_back(issue);
+    // concurrent calls for the same board wait for a single refresh, other boards don't wait
+    std::lock_guard<std::mutex> guard(boardLock(board_id));
+    if (!index.isFresh(board_id)) {
+        refreshSprints(board_id);
+    }
+    return board_id;
+}
+
+std::mutex& JiraClient::boardLock(int board_id) {
+    std::lock_guard<std::mutex> guard(board_mutex);
+    std::unique_ptr<std::mutex>& lock = board_locks[board_id];
+    if (!lock) {
+        lock.reset(new std::mutex());
+    }
+    return *lock;
+}
+
+void JiraClient::refreshSprints(int board_id) {
+    std::vector<JiraSprint> known = index.sprints(board_id);
+    std::map<int, JiraSprint> listed;
+    auto list = [this, board_id, &listed](const std::string& state, int skip) {
+        std::map<std::string, std::string> params;
+        if (!state.empty()) {
+            params["state"] = state;
+        }
+        PageIterator pages = paginate(this->agile_url + "/board/" + to_string(board_id) + "/sprint", params, "values", "sprints");
+        pages.skip(skip);
+        while (pages.next()) {
+            auto mapping_start = Clock::now();
+            for (const auto& element : pages.items()) {
+                std::unique_ptr<JiraSprint> sprint(JiraSprint::fromJSON(element));
+                listed[sprint->id] = *sprint;
             }
+            metrics.recordMapping("sprint", secondsSince(mapping_start), pages.items().size());
+        }
+    };
+    if (known.empty()) {
+        list("", 0);
+    } else {
+        // closed sprints never change: active and future ones are requested again, and closed
+        // ones after those already known (new sprints are appended, so they can't be skipped)
+        int known_closed = static_cast<int>(std::count_if(known.begin(), known.end(), [](const JiraSprint& sprint) {
+            return sprint.is_closed;
+        }));
+        list("active,future", 0);
+        list("closed", known_closed);
+    }
+    std::vector<JiraSprint> sprints;
+    for (const auto& sprint : listed) {
+        sprints.push_back(sprint.second);
+    }
+    for (const auto& sprint : known) {
+        if (listed.find(sprint.id) != listed.end()) {
+            continue;
+        }
+        if (sprint.is_closed) {
             sprints.push_back(sprint);
+        } else {
+            // the sprint was open last time, it has been closed (or deleted) since then
+            auto response = scheduler->get(this->agile_url + "/sprint/" + to_string(sprint.id));
+            if (response.status_code == 200) {
+                std::unique_ptr<JiraSprint> closed(JiraSprint::fromJSON(json::parse(response.text)));
+                sprints.push_back(*closed);
+            } else if (response.status_code != 404) {
+                throw std::logic_error(std::string("Get sprint returned incorrect code: ") + to_string(response.status_code));
+            }
         }
     }
-    if (sprints.size() == 0) {
-        client_logger->warn("Are you sure that provided sprint names were correct? No sprints matches names was found.");
+    JIRA_LOG_DEBUG(client_logger, "Board {} has {} sprints", board_id, sprints.size());
+    index.setSprints(board_id, std::move(sprints));
+    saveIndex();
+}
+
+std::vector<JiraSprint*> JiraClient::takeSprints(const std::vector<JiraSprint>& selected) {
+    std::vector<JiraSprint*> sprints;
+    for (const auto& metadata : selected) {
+        JiraSprint* sprint = arena.sprints.create();
+        *sprint = metadata;
+        client_logger->info("Found sprint: {}\n--Started at: {}\n--Ended at: {}", sprint->name, Utils::timeToString(sprint->start_date), Utils::timeToString(sprint->end_date));
+        sprints.push_back(sprint);
     }
     return sprints;
 }
 
+void JiraClient::saveIndex() {
+    if (cache) {
+        index.save(cache->directory() + "/index.json");
+    }
+}
+
+void JiraClient::setExecutor(std::shared_ptr<Executor> executor) {
+    if (!executor) {
+        throw std::invalid_argument("Executor is not provided");
+    }
+    this->executor = executor;
+}
 
+void JiraClient::setRateLimit(const SchedulerOptions options) {
+    scheduler->setOptions(options);
+}
 
-std::vector<JiraSprint*> JiraClient::getSprints(const string board_name, const string start_date, const string end_date){
-    client_logger->trace("JiraClient::getSprints() called for board {} between {} and {}", board_name, start_date, end_date);
-    vector<JiraSprint*> sprints;
-    time_t request_start_date = Utils::parseTimestapm(start_date);
-    time_t request_end_date = Utils::parseTimestapm(end_date);
-    // Looking for right Jira Board
-    auto url = Url{this->agile_url + "/board"};
-    auto auth = Authentication(this->user, this->token);
-    auto response = Get(url, auth);
-    if (response.status_code != 200) {
-        throw std::logic_error(std::string("Get board returned incorrect code: ") + to_string(response.status_code));
+const Metrics& JiraClient::getMetrics() const {
+    return metrics;
+}
+
+SchedulerStats JiraClient::requestStats() const {
+    return scheduler->stats();
+}
+
+void JiraClient::setIssueQuery(const IssueQuery query) {
+    this->issue_query = query;
+}
+
+void JiraClient::setParseOptions(const ParseOptions options) {
+    this->parse_options = options;
+}
+
+void JiraClient::setTrackedPeople(const std::vector<JiraUser*>& people) {
+    tracked_accounts.clear();
+    for (auto person : people) {
+        tracked_accounts.push_back(person->id);
     }
-    // client_logger->info(response.text);
-    json all_boards = json::parse(response.text);
-    json board;
-    for (auto& element : all_boards["values"]) {
-        if (board_name.compare(element["name"].get<string>()) == 0) {
-            board = element;
+}
+
+void JiraClient::setConcurrency(size_t workers) {
+    this->fetch_workers = std::max<size_t>(workers, 1);
+}
+
+void JiraClient::setCacheDirectory(const std::string directory) {
+    this->cache = std::unique_ptr<SprintCache>(new SprintCache(directory));
+    index.load(cache->directory() + "/index.json");
+    users.load(cache->directory() + "/users.json");
+    client_logger->info("Sprint cache is stored in {}", directory);
+}
+
+void JiraClient::setUserTtl(double seconds) {
+    users.setTtl(seconds);
+}
+
+std::map<int, CachedSprint> JiraClient::syncOpenSprints(const std::vector<JiraSprint*>& sprints) {
+    // open sprints which were downloaded before, grouped by board
+    std::map<int, std::map<int, CachedSprint>> boards;
+    for (auto sprint : sprints) {
+        CachedSprint entry;
+        if (sprint->is_closed || !cache->load(sprint->board_id, sprint->id, entry) || entry.closed || entry.synced_at == 0 || entry.query != queryKey()) {
+            continue;
         }
+        boards[sprint->board_id][sprint->id] = std::move(entry);
     }
-    if (board.is_null()) {
-        throw std::logic_error(std::string("Cannot find a board with namee: ") + board_name);
-    }
-    // Looking for all sprints in the Board that will fit dates
-    url = Url{this->agile_url + "/board/" + to_string(board.at("id").get<int>()) + "/sprint" };
-    response = Get(url, auth);
-    if (response.status_code != 200) {
-        throw std::logic_error(std::string("Get sprints returned incorrect code: ") + to_string(response.status_code));
-    }
-    json all_sprints = json::parse(response.text);
-    for (auto& element : all_sprints["values"]) {
-        JiraSprint* sprint = JiraSprint::fromJSON(element.dump());
-        // filter sprint by date
-        bool started_inside_requested_period = difftime(sprint->start_date, request_start_date) > 0;
-        bool ended_inside_requested_period = difftime(sprint->complete_date, request_end_date) < 0;
-        client_logger->debug("Checking that sprint {} was\n--started after {} - {}\n--ended before {} - {}",
-                        sprint->name,
-                        Utils::timeToString(sprint->start_date), started_inside_requested_period,
-                        Utils::timeToString(sprint->end_date), ended_inside_requested_period);
-        if (started_inside_requested_period && ended_inside_requested_period) {
-            client_logger->info("Found sprint: {}\n--Started at: {}\n--Ended at: {}", sprint->name, Utils::timeToString(sprint->start_date), Utils::timeToString(sprint->end_date));
-            client_logger->info("Taking issues for the sprint ...");
-            auto url = Url{this->agile_url + "/board/" + to_string(sprint->board_id) +"/sprint/" +  to_string(sprint->id) + "/issue"};
-            auto auth = Authentication(this->user, this->token);
-            auto params = Parameters({{"maxResults", MAX_ISSUES_IN_REQUEST}});
-            auto response = Get(url, auth, params);
-            if (response.status_code != 200) {
-                throw std::logic_error(std::string("Get users returned incorrect code: ") + to_string(response.status_code));
-            }
-            json search_result = json::parse(response.text);
-            for(auto json_issue : search_result["issues"]) {
-                JiraIssue* issue = JiraIssue::fromJSON(json_issue.dump());
-                client_logger->debug("Found issue {}", issue->key);
-                sprint->issues.push_back(issue);
+    std::map<int, CachedSprint> synced;
+    for (auto& board : boards) {
+        // watermark of the board is the oldest synchronization of its sprints
+        time_t watermark = board.second.begin()->second.synced_at;
+        for (const auto& entry : board.second) {
+            watermark = std::min(watermark, entry.second.synced_at);
+        }
+        time_t sync_start = time(nullptr);
+        // JQL has minute precision, relative time doesn't depend on time zones; extra minutes cover clock skew
+        long minutes = static_cast<long>(difftime(sync_start, watermark)) / 60 + 2;
+        client_logger->info("Syncing issues of board {} updated during last {} minutes", board.first, minutes);
+        PageIterator pages = paginate(
+            this->agile_url + "/board/" + to_string(board.first) + "/issue",
+            // people are not filtered by JQL, otherwise issues reassigned to someone else would never come back
+            issueParams("updated >= -" + to_string(minutes) + "m", false), "issues", "board issues");
+        size_t changed = 0;
+        while (pages.next()) {
+            for (const auto& json_issue : pages.items()) {
+                changed++;
+                // agile API puts the active (or future) sprint of the issue into "sprint" field
+                int current_sprint = 0;
+                auto found = json_issue.at("fields").find("sprint");
+                if (found != json_issue.at("fields").end() && found->is_object()) {
+                    current_sprint = found->value("id", 0);
+                }
+                bool tracked = tracksIssue(json_issue);
+                for (auto& entry : board.second) {
+                    mergeIssue(entry.second, json_issue, tracked && entry.first == current_sprint);
+                }
             }
-            sprints.push_back(sprint);
+        }
+        client_logger->info("{} issues were updated on board {} since the last sync", changed, board.first);
+        for (auto& entry : board.second) {
+            entry.second.synced_at = sync_start;
+            cache->store(board.first, entry.first, entry.second);
+            synced[entry.first] = std::move(entry.second);
         }
     }
-    if (sprints.size() == 0) {
-        client_logger->warn("Are you sure that start and end date a correct? No sprints inside period {} - {} was found.", Utils::timeToString(request_start_date), Utils::timeToString(request_end_date));
+    return synced;
+}
+
+void JiraClient::mergeIssue(CachedSprint& entry, const json& json_issue, bool belongs) {
+    const std::string& id = json_issue.at("id").get_ref<const std::string&>();
+    auto position = std::find_if(entry.issues.begin(), entry.issues.end(), [&id](const json& cached_issue) {
+        return cached_issue.at("id").get_ref<const std::string&>() == id;
+    });
+    if (!belongs) {
+        // issue was moved out of the sprint
+        if (position != entry.issues.end()) {
+            entry.issues.erase(position);
+        }
+    } else if (position != entry.issues.end()) {
+        *position = json_issue;
+    } else {
+        entry.issues.push_back(json_issue);
     }
-    return sprints;
 }
 
-PersonalResult* JiraClient::getPersonResults(const JiraUser& person, const JiraSprint& sprint) {
-    client_logger->info("Looking at sprint: {}", sprint.name);
-    client_logger->info("Counting issues for: {}", person.name);
-    PersonalResult *results = new PersonalResult();
-    for(auto issue : sprint.issues) {
-        bool reviewed;
-        for(auto comment: issue->comments) {
-            if (difftime(comment.published_date, sprint.end_date) < 0 && difftime(comment.published_date, sprint.start_date) > 0 ) {
-                if (comment.authour_id == person.id) {
-                    client_logger->debug("Found comment for {} with text: {}", person.name, comment.text.substr(0, 15));
-                    results->comments_written.push_back(comment);
-                }
-                if (comment.authour_id == person.id && (issue->assignee_id != person.id)) {
-                    reviewed = true;
-                    client_logger->debug("Found review for {} in issue {}", person.name, issue->key);
+void JiraClient::fetchIssues(JiraSprint& sprint, CachedSprint* synced) {
+    CachedSprint cached;
+    // issues of closed sprints never change, open ones are taken from cache only after delta sync
+    bool from_cache = synced != nullptr || (sprint.is_closed && cache && cache->load(sprint.board_id, sprint.id, cached) && cached.closed && cached.query == queryKey());
+    if (from_cache) {
+        const json& issues = synced != nullptr ? synced->issues : cached.issues;
+        client_logger->info("Taking issues for the sprint {} from cache", sprint.name);
+        auto mapping_start = Clock::now();
+        sprint.issues = JiraIssue::fromJSONArray(issues, &arena, parse_options, executor.get());
+        metrics.recordMapping("issue", secondsSince(mapping_start), issues.size());
+        return;
+    }
+    client_logger->info("Taking issues for the sprint {} ...", sprint.name);
+    CachedSprint downloaded;
+    downloaded.closed = sprint.is_closed;
+    downloaded.synced_at = time(nullptr);
+    downloaded.query = queryKey();
+    const std::string url = this->agile_url + "/board/" + to_string(sprint.board_id) +"/sprint/" +  to_string(sprint.id) + "/issue";
+    if (!cache) {
+        // nothing keeps the JSON, so pages go straight into objects; mapping is counted as parsing
+        PageIterator pages(pageLoader(url, issueParams(""), "issues"), [this, &sprint](const std::string& body) {
+            return JiraIssue::fromPage(body, "issues", sprint.issues, &arena, parse_options, executor.get());
+        }, &this->metrics);
+        while (pages.next()) {}
+        return;
+    }
+    PageIterator pages = paginate(url, issueParams(""), "issues", "issues");
+    // the next page is already requested while issues of the current one are parsed
+    while (pages.next()) {
+        auto mapping_start = Clock::now();
+        std::vector<JiraIssue*> issues = JiraIssue::fromJSONArray(pages.items(), &arena, parse_options, executor.get());
+        sprint.issues.insert(sprint.issues.end(), issues.begin(), issues.end());
+        for(const auto& json_issue : pages.items()) {
+            downloaded.issues.push_back(json_issue);
+        }
+        metrics.recordMapping("issue", secondsSince(mapping_start), pages.items().size());
+    }
+    cache->store(sprint.board_id, sprint.id, downloaded);
+}
+
+std::map<std::string, std::string> JiraClient::issueParams(const std::string& jql, bool filter_people) const {
+    std::map<std::string, std::string> params = {{"maxResults", MAX_ISSUES_IN_REQUEST}};
+    if (!issue_query.fields.empty()) {
+        params["fields"] = issue_query.fields;
+        if (cache) {
+            // delta sync places cached issues by their sprint and update time
+            for (const std::string field : {"sprint", "updated"}) {
+                if (("," + issue_query.fields + ",").find("," + field + ",") == std::string::npos) {
+                    params["fields"] += "," + field;
                 }
             }
         }
-        if (reviewed) {
-            results->issues_reviwed++;
+    }
+    if (!issue_query.expand.empty()) {
+        params["expand"] = issue_query.expand;
+    }
+    std::string filter = filter_people ? peopleFilter() : "";
+    if (!filter.empty() && !jql.empty()) {
+        params["jql"] = filter + " AND " + jql;
+    } else if (!filter.empty() || !jql.empty()) {
+        params["jql"] = filter + jql;
+    }
+    return params;
+}
+
+std::string JiraClient::peopleFilter() const {
+    if (tracked_accounts.empty()) {
+        return "";
+    }
+    std::string accounts;
+    for (const auto& account : tracked_accounts) {
+        accounts += (accounts.empty() ? "\"" : ", \"") + account + "\"";
+    }
+    std::string filter = "assignee in (" + accounts + ")";
+    if (!issue_query.comment_clause.empty()) {
+        const std::string placeholder = "{account}";
+        for (const auto& account : tracked_accounts) {
+            std::string clause = issue_query.comment_clause;
+            for (size_t position = clause.find(placeholder); position != std::string::npos; position = clause.find(placeholder, position + account.size())) {
+                clause.replace(position, placeholder.size(), account);
+            }
+            filter += " OR " + clause;
+        }
+    }
+    return "(" + filter + ")";
+}
+
+bool JiraClient::tracksIssue(const json& json_issue) const {
+    if (tracked_accounts.empty()) {
+        return true;
+    }
+    auto isTracked = [this](const json& user) {
+        if (!user.is_object()) {
+            return false;
+        }
+        std::string account = user.value("accountId", "");
+        return std::find(tracked_accounts.begin(), tracked_accounts.end(), account) != tracked_accounts.end();
+    };
+    const json& fields = json_issue.at("fields");
+    auto assignee = fields.find("assignee");
+    if (assignee != fields.end() && isTracked(*assignee)) {
+        return true;
+    }
+    if (issue_query.comment_clause.empty()) {
+        return false;
+    }
+    // the comment clause is checked by authors of the returned comments
+    auto comment = fields.find("comment");
+    if (comment == fields.end() || !comment->is_object()) {
+        return false;
+    }
+    for (const auto& json_comment : comment->value("comments", json::array())) {
+        if (json_comment.is_object() && isTracked(json_comment.value("author", json()))) {
+            return true;
         }
-        if (issue->assignee_id == person.id) {
-            if (issue->resolved && ( difftime(issue->resolution_date, sprint.end_date) < 0)) {
-                results->finished.push_back(issue);
-            } else {
-                results->not_finished.push_back(issue);
+    }
+    return false;
+}
+
+std::string JiraClient::queryKey() const {
+    return issue_query.fields + "|" + issue_query.expand + "|" + peopleFilter();
+}
+
+PageIterator JiraClient::paginate(const std::string url, const std::map<std::string, std::string> params, const std::string items_key, const std::string description) {
+    return PageIterator(pageLoader(url, params, description), items_key, &this->metrics);
+}
+
+PageIterator::PageLoader JiraClient::pageLoader(const std::string url, const std::map<std::string, std::string> params, const std::string description) {
+    RequestScheduler* scheduler = this->scheduler.get();
+    return [scheduler, url, params, description](int start_at) {
+        std::map<std::string, std::string> page_params = params;
+        page_params["startAt"] = to_string(start_at);
+        auto response = scheduler->get(url, page_params);
+        if (response.status_code != 200) {
+            throw std::logic_error(std::string("Get ") + description + " returned incorrect code: " + to_string(response.status_code));
+        }
+        return response.text;
+    };
+}
+
+void JiraClient::fetchIssues(const std::vector<JiraSprint*>& sprints) {
+    // Open sprints known from previous runs get only their changed issues
+    std::map<int, CachedSprint> synced;
+    if (cache) {
+        synced = syncOpenSprints(sprints);
+    }
+    // Each worker takes the next sprint which is not fetched yet and parses its issues
+    // right after the response arrives. Sprints keep their positions in the vector.
+    std::atomic<size_t> next(0);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto worker = [&]() {
+        for (size_t index = next++; index < sprints.size(); index = next++) {
+            try {
+                auto found = synced.find(sprints[index]->id);
+                fetchIssues(*sprints[index], found != synced.end() ? &found->second : nullptr);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next = sprints.size();
             }
         }
+    };
+    // workers run on the shared executor, so sprints of all requested boards share its threads
+    size_t workers = std::min(fetch_workers, sprints.size());
+    std::vector<std::future<void>> tasks;
+    for (size_t i = 1; i < workers; i++) {
+        tasks.push_back(executor->submit(worker));
+    }
+    worker();
+    for (auto& task : tasks) {
+        executor->wait(task);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+PersonalResult* JiraClient::getPersonResults(const JiraUser& person, const JiraSprint& sprint) {
+    JiraUser user = person;
+    std::vector<JiraUser*> people = {&user};
+    return getSprintResults(people, sprint).front();
+}
+
+std::vector<PersonalResult*> JiraClient::getSprintResults(const std::vector<JiraUser*>& people, const JiraSprint& sprint) {
+    client_logger->info("Looking at sprint: {}", sprint.name);
+    auto aggregation_start = Clock::now();
+    std::vector<PersonalResult*> results = SprintAggregator(people).aggregate(sprint, &arena);
+    metrics.recordAggregation(secondsSince(aggregation_start));
+    for (size_t i = 0; i < people.size(); i++) {
+        client_logger->info("Finished issues for {}: {}", people[i]->name, results[i]->finished.size());
     }
-    client_logger->info("Finished issues: {}", results->finished.size());
     return results;
 }
@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "jira/local_server.hpp"
+
+namespace {
+    const size_t MAX_HEADER_SIZE = 64 * 1024;
+    const size_t MAX_BODY_SIZE = 1024 * 1024;
+
+    std::string lowerCase(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+        return text;
+    }
+
+    std::string decode(const std::string& text) {
+        std::string decoded;
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '+') {
+                decoded.push_back(' ');
+            } else if (text[i] == '%' && i + 2 < text.size() && std::isxdigit(static_cast<unsigned char>(text[i + 1])) && std::isxdigit(static_cast<unsigned char>(text[i + 2]))) {
+                decoded.push_back(static_cast<char>(std::stoi(text.substr(i + 1, 2), nullptr, 16)));
+                i += 2;
+            } else {
+                decoded.push_back(text[i]);
+            }
+        }
+        return decoded;
+    }
+
+    const char* reason(long status_code) {
+        switch (status_code) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 404: return "Not Found";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "Unknown";
+        }
+    }
+
+    bool sendAll(int connection, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t written = send(connection, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (written <= 0) {
+                return false;
+            }
+            sent += static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    // Parses the request line and headers, returns 0 or the status code of the error
+    long parseRequest(const std::string& head, HttpRequest& request, size_t& body_size) {
+        size_t line_end = head.find("\r\n");
+        std::string line = head.substr(0, line_end);
+        size_t method_end = line.find(' ');
+        size_t target_end = line.find(' ', method_end + 1);
+        if (method_end == std::string::npos || target_end == std::string::npos) {
+            return 400;
+        }
+        request.method = line.substr(0, method_end);
+        std::string target = line.substr(method_end + 1, target_end - method_end - 1);
+        size_t query = target.find('?');
+        request.path = decode(target.substr(0, query));
+        if (query != std::string::npos) {
+            std::string parameters = target.substr(query + 1);
+            for (size_t begin = 0; begin <= parameters.size();) {
+                size_t end = std::min(parameters.find('&', begin), parameters.size());
+                std::string pair = parameters.substr(begin, end - begin);
+                size_t equals = pair.find('=');
+                if (!pair.empty()) {
+                    request.params[decode(pair.substr(0, equals))] = equals == std::string::npos ? "" : decode(pair.substr(equals + 1));
+                }
+                begin = end + 1;
+            }
+        }
+        body_size = 0;
+        for (size_t begin = line_end + 2; begin < head.size();) {
+            size_t end = head.find("\r\n", begin);
+            if (end == std::string::npos) {
+                end = head.size();
+            }
+            std::string header = head.substr(begin, end - begin);
+            size_t colon = header.find(':');
+            if (colon != std::string::npos) {
+                size_t value = header.find_first_not_of(' ', colon + 1);
+                std::string name = lowerCase(header.substr(0, colon));
+                request.headers[name] = value == std::string::npos ? "" : header.substr(value);
+                if (name == "content-length") {
+                    const std::string& length = request.headers[name];
+                    if (length.empty() || length.find_first_not_of("0123456789") != std::string::npos) {
+                        return 400;
+                    }
+                    // compared by digits first, so huge values don't overflow
+                    if (length.size() > std::to_string(MAX_BODY_SIZE).size() || std::stoul(length) > MAX_BODY_SIZE) {
+                        return 413;
+                    }
+                    body_size = std::stoul(length);
+                }
+            }
+            begin = end + 2;
+        }
+        return 0;
+    }
+}
+
+LocalHttpServer::LocalHttpServer(Handler handler, int port, const std::string address) {
+    this->handler = handler;
+    this->address = address;
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw std::runtime_error("Cannot open a socket");
+    }
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in socket_address = {};
+    socket_address.sin_family = AF_INET;
+    socket_address.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, address.c_str(), &socket_address.sin_addr) != 1
+        || bind(listener, reinterpret_cast<sockaddr*>(&socket_address), sizeof(socket_address)) != 0
+        || listen(listener, SOMAXCONN) != 0) {
+        close(listener);
+        throw std::runtime_error("Cannot listen on " + address + ":" + std::to_string(port));
+    }
+    socklen_t length = sizeof(socket_address);
+    getsockname(listener, reinterpret_cast<sockaddr*>(&socket_address), &length);
+    listen_port = ntohs(socket_address.sin_port);
+    acceptor = std::thread(&LocalHttpServer::acceptConnections, this);
+}
+
+LocalHttpServer::~LocalHttpServer() {
+    stop();
+}
+
+int LocalHttpServer::port() const {
+    return listen_port;
+}
+
+std::string LocalHttpServer::url() const {
+    return "http://" + address + ":" + std::to_string(listen_port);
+}
+
+void LocalHttpServer::stop() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+        // wakes up blocked accept() and recv() calls
+        shutdown(listener, SHUT_RDWR);
+        for (int connection : connections) {
+            shutdown(connection, SHUT_RDWR);
+        }
+    }
+    acceptor.join();
+    close(listener);
+    std::unique_lock<std::mutex> lock(mutex);
+    all_closed.wait(lock, [this]() { return connections.empty(); });
+}
+
+void LocalHttpServer::acceptConnections() {
+    std::chrono::milliseconds backoff(0);
+    for (;;) {
+        int connection = accept(listener, nullptr, nullptr);
+        int error = errno;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (stopping) {
+                if (connection >= 0) {
+                    close(connection);
+                }
+                return;
+            }
+            if (connection >= 0) {
+                backoff = std::chrono::milliseconds(0);
+                connections.insert(connection);
+                std::thread(&LocalHttpServer::serve, this, connection).detach();
+                continue;
+            }
+        }
+        if (error == EBADF || error == EINVAL || error == ENOTSOCK || error == EOPNOTSUPP) {
+            // the listening socket is unusable, retrying would spin forever
+            return;
+        }
+        if (error != EINTR && error != ECONNABORTED) {
+            // out of descriptors or memory: give connections some time to close
+            backoff = std::min(std::max(backoff * 2, std::chrono::milliseconds(10)), std::chrono::milliseconds(200));
+            std::this_thread::sleep_for(backoff);
+        }
+    }
+}
+
+void LocalHttpServer::serve(int connection) {
+    std::string buffer;
+    char chunk[16 * 1024];
+    bool keep_alive = true;
+    while (keep_alive) {
+        size_t head_end;
+        while ((head_end = buffer.find("\r\n\r\n")) == std::string::npos && buffer.size() < MAX_HEADER_SIZE) {
+            ssize_t received = recv(connection, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                break;
+            }
+            buffer.append(chunk, static_cast<size_t>(received));
+        }
+        if (head_end == std::string::npos) {
+            break;
+        }
+        HttpRequest request;
+        size_t body_size = 0;
+        long error_code = parseRequest(buffer.substr(0, head_end), request, body_size);
+        HttpResponse response;
+        if (error_code != 0) {
+            // the rest of the request cannot be trusted, so the connection is closed after the answer
+            keep_alive = false;
+            response.status_code = error_code;
+            response.text = error_code == 413 ? "{\"errorMessages\":[\"Request body is too large\"]}" : "{\"errorMessages\":[\"Malformed request\"]}";
+        } else {
+            // bodies are not used, but they have to be read out of the connection
+            while (buffer.size() < head_end + 4 + body_size) {
+                ssize_t received = recv(connection, chunk, sizeof(chunk), 0);
+                if (received <= 0) {
+                    break;
+                }
+                buffer.append(chunk, static_cast<size_t>(received));
+            }
+            buffer.erase(0, std::min(buffer.size(), head_end + 4 + body_size));
+            keep_alive = lowerCase(request.headers["connection"]) != "close";
+            try {
+                response = handler(request);
+            } catch (const std::exception& error) {
+                response = HttpResponse();
+                response.status_code = 500;
+                response.text = error.what();
+            }
+        }
+        std::string head = "HTTP/1.1 " + std::to_string(response.status_code) + " " + reason(response.status_code) + "\r\n";
+        if (response.headers.find("content-type") == response.headers.end()) {
+            head += "Content-Type: application/json\r\n";
+        }
+        for (const auto& header : response.headers) {
+            head += header.first + ": " + header.second + "\r\n";
+        }
+        head += "Content-Length: " + std::to_string(response.text.size()) + "\r\n";
+        head += keep_alive ? "\r\n" : "Connection: close\r\n\r\n";
+        if (!sendAll(connection, head + response.text)) {
+            break;
+        }
+    }
+    // closed under the lock, so stop() never touches a descriptor reused by another connection
+    std::lock_guard<std::mutex> guard(mutex);
+    connections.erase(connection);
+    close(connection);
+    all_closed.notify_all();
+}
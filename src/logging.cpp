@@ -0,0 +1,9 @@
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include "logging.hpp"
+
+std::shared_ptr<spdlog::logger> makeLogger(const std::string& name) {
+    // the shared thread pool is created together with the first async logger
+    return spdlog::create_async<spdlog::sinks::stdout_color_sink_mt>(name);
+}
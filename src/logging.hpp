@@ -0,0 +1,44 @@
+/**
+ * @file logging.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Loggers of the library and macros for logging on hot paths
+ * @version 0.1
+ * @date 2020-07-02
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef LOGGING_H_
+#define LOGGING_H_
+
+#include <memory>
+#include <string>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief Create a logger which writes to stdout from a background thread
+ *
+ * All loggers of the library share one thread, so a call to a logger only
+ * formats the message and puts it into a queue.
+ *
+ * @param [in] name name of the logger, must be unique
+ * @return std::shared_ptr<spdlog::logger> registered logger
+ */
+std::shared_ptr<spdlog::logger> makeLogger(const std::string& name);
+
+// Trace and debug messages are compiled out when SPDLOG_ACTIVE_LEVEL (JIRA_LOG_LEVEL in CMake)
+// is higher. Otherwise arguments are evaluated only if the logger accepts the level.
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define JIRA_LOG_TRACE(logger, ...) do { if ((logger)->should_log(spdlog::level::trace)) { (logger)->trace(__VA_ARGS__); } } while (0)
+#else
+#define JIRA_LOG_TRACE(logger, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define JIRA_LOG_DEBUG(logger, ...) do { if ((logger)->should_log(spdlog::level::debug)) { (logger)->debug(__VA_ARGS__); } } while (0)
+#else
+#define JIRA_LOG_DEBUG(logger, ...) (void)0
+#endif
+
+#endif // LOGGING_H_
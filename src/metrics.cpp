@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "jira/metrics.hpp"
+
+using json = nlohmann::json;
+
+const std::vector<double> Metrics::LATENCY_BUCKETS = {0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+
+namespace {
+    std::string bucketBound(size_t bucket) {
+        if (bucket == Metrics::LATENCY_BUCKETS.size()) {
+            return "+Inf";
+        }
+        std::ostringstream bound;
+        bound << Metrics::LATENCY_BUCKETS[bucket];
+        return bound.str();
+    }
+}
+
+void Metrics::Histogram::observe(double value) {
+    size_t bucket = std::lower_bound(LATENCY_BUCKETS.begin(), LATENCY_BUCKETS.end(), value) - LATENCY_BUCKETS.begin();
+    counts[bucket]++;
+    sum += value;
+    count++;
+}
+
+std::string Metrics::endpoint(const std::string& url) {
+    size_t begin = url.find("://");
+    begin = url.find('/', begin == std::string::npos ? 0 : begin + 3);
+    if (begin == std::string::npos) {
+        return "/";
+    }
+    size_t end = std::min(url.find('?', begin), url.size());
+    std::string path;
+    std::string previous;
+    for (size_t position = begin; position < end;) {
+        size_t next = std::min(url.find('/', position + 1), end);
+        std::string segment = url.substr(position + 1, next - position - 1);
+        bool numeric = !segment.empty() && std::all_of(segment.begin(), segment.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+        // "rest/api/3" is a version of the API, not an id
+        path += "/" + (numeric && previous != "api" ? std::string("{id}") : segment);
+        previous = segment;
+        position = next;
+    }
+    return path;
+}
+
+void Metrics::recordRequest(const std::string& url, long status_code, double seconds, size_t bytes) {
+    std::string label = endpoint(url);
+    std::lock_guard<std::mutex> guard(mutex);
+    EndpointStats& stats = requests[label];
+    stats.latency.observe(seconds);
+    stats.bytes += bytes;
+    if (status_code < 200 || status_code >= 300) {
+        stats.errors++;
+    }
+}
+
+void Metrics::recordParse(double seconds, size_t bytes) {
+    std::lock_guard<std::mutex> guard(mutex);
+    parse_time.observe(seconds);
+    parsed_bytes += bytes;
+}
+
+void Metrics::recordMapping(const std::string& type, double seconds, size_t objects) {
+    std::lock_guard<std::mutex> guard(mutex);
+    Totals& totals = this->objects[type];
+    totals.seconds += seconds;
+    totals.count += objects;
+}
+
+void Metrics::recordAggregation(double seconds) {
+    std::lock_guard<std::mutex> guard(mutex);
+    aggregation.seconds += seconds;
+    aggregation.count++;
+}
+
+json Metrics::toJSON() const {
+    auto histogram = [](const Histogram& source) {
+        json buckets = json::object();
+        for (size_t i = 0; i < source.counts.size(); i++) {
+            buckets[bucketBound(i)] = source.counts[i];
+        }
+        return json{{"buckets", buckets}, {"sum", source.sum}, {"count", source.count}};
+    };
+    std::lock_guard<std::mutex> guard(mutex);
+    json result = {
+        {"requests", json::object()},
+        {"parse", {{"seconds", histogram(parse_time)}, {"bytes", parsed_bytes}}},
+        {"objects", json::object()},
+        {"aggregation", {{"seconds", aggregation.seconds}, {"count", aggregation.count}}}};
+    for (const auto& entry : requests) {
+        result["requests"][entry.first] = {
+            {"seconds", histogram(entry.second.latency)},
+            {"bytes", entry.second.bytes},
+            {"errors", entry.second.errors}};
+    }
+    for (const auto& entry : objects) {
+        result["objects"][entry.first] = {{"seconds", entry.second.seconds}, {"count", entry.second.count}};
+    }
+    return result;
+}
+
+std::string Metrics::toPrometheus() const {
+    std::ostringstream out;
+    // buckets are cumulative in Prometheus
+    auto histogram = [&out](const std::string& name, const std::string& labels, const Histogram& source) {
+        uint64_t cumulative = 0;
+        std::string separator = labels.empty() ? "" : ",";
+        for (size_t i = 0; i < source.counts.size(); i++) {
+            cumulative += source.counts[i];
+            out << name << "_bucket{" << labels << separator << "le=\"" << bucketBound(i) << "\"} " << cumulative << "\n";
+        }
+        std::string braces = labels.empty() ? "" : "{" + labels + "}";
+        out << name << "_sum" << braces << " " << source.sum << "\n";
+        out << name << "_count" << braces << " " << source.count << "\n";
+    };
+    std::lock_guard<std::mutex> guard(mutex);
+    out << "# HELP jira_request_duration_seconds Latency of Jira API requests\n";
+    out << "# TYPE jira_request_duration_seconds histogram\n";
+    for (const auto& entry : requests) {
+        histogram("jira_request_duration_seconds", "endpoint=\"" + entry.first + "\"", entry.second.latency);
+    }
+    out << "# HELP jira_response_bytes_total Size of response bodies\n";
+    out << "# TYPE jira_response_bytes_total counter\n";
+    for (const auto& entry : requests) {
+        out << "jira_response_bytes_total{endpoint=\"" << entry.first << "\"} " << entry.second.bytes << "\n";
+    }
+    out << "# HELP jira_request_errors_total Responses with status other than 2xx\n";
+    out << "# TYPE jira_request_errors_total counter\n";
+    for (const auto& entry : requests) {
+        out << "jira_request_errors_total{endpoint=\"" << entry.first << "\"} " << entry.second.errors << "\n";
+    }
+    out << "# HELP jira_json_parse_seconds Time of parsing of JSON pages\n";
+    out << "# TYPE jira_json_parse_seconds histogram\n";
+    histogram("jira_json_parse_seconds", "", parse_time);
+    out << "# HELP jira_json_parsed_bytes_total Size of parsed JSON pages\n";
+    out << "# TYPE jira_json_parsed_bytes_total counter\n";
+    out << "jira_json_parsed_bytes_total " << parsed_bytes << "\n";
+    out << "# HELP jira_objects_created_total Objects created from JSON\n";
+    out << "# TYPE jira_objects_created_total counter\n";
+    for (const auto& entry : objects) {
+        out << "jira_objects_created_total{type=\"" << entry.first << "\"} " << entry.second.count << "\n";
+    }
+    out << "# HELP jira_mapping_seconds_total Time of creating objects from JSON\n";
+    out << "# TYPE jira_mapping_seconds_total counter\n";
+    for (const auto& entry : objects) {
+        out << "jira_mapping_seconds_total{type=\"" << entry.first << "\"} " << entry.second.seconds << "\n";
+    }
+    out << "# HELP jira_aggregation_seconds_total Time of counting sprint results\n";
+    out << "# TYPE jira_aggregation_seconds_total counter\n";
+    out << "jira_aggregation_seconds_total " << aggregation.seconds << "\n";
+    out << "# HELP jira_aggregations_total Number of counted sprint results\n";
+    out << "# TYPE jira_aggregations_total counter\n";
+    out << "jira_aggregations_total " << aggregation.count << "\n";
+    return out.str();
+}
+
+void Metrics::save(const std::string& path) const {
+    const std::string prometheus_extension = ".prom";
+    bool prometheus = path.size() >= prometheus_extension.size()
+        && path.compare(path.size() - prometheus_extension.size(), prometheus_extension.size(), prometheus_extension) == 0;
+    std::ofstream file(path);
+    file << (prometheus ? toPrometheus() : toJSON().dump(4));
+    if (!file.good()) {
+        throw std::runtime_error("Cannot write metrics file: " + path);
+    }
+}
@@ -0,0 +1,106 @@
+#include <chrono>
+
+#include "jira/pagination.hpp"
+#include "jira/metrics.hpp"
+
+using json = nlohmann::json;
+
+PageIterator::PageIterator(PageLoader loader, const std::string items_key, Metrics* metrics) {
+    this->loader = loader;
+    this->items_key = items_key;
+    this->metrics = metrics;
+}
+
+PageIterator::PageIterator(PageLoader loader, PageParser parser, Metrics* metrics) {
+    this->loader = loader;
+    this->parser = parser;
+    this->metrics = metrics;
+}
+
+void PageIterator::prefetch(int start_at) {
+    // not Executor::submit: see the class comment, waiting for it under a lock may deadlock
+    pending = std::async(std::launch::async, loader, start_at);
+}
+
+void PageIterator::skip(int items) {
+    first = items;
+}
+
+bool PageIterator::next() {
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if (finished) {
+        return false;
+    }
+    if (!started) {
+        started = true;
+        prefetch(first);
+    }
+    PageEnvelope envelope;
+    try {
+        // the future is invalid after get(), so a failure is kept for the next calls
+        std::string body = pending.get();
+        auto parse_start = std::chrono::steady_clock::now();
+        envelope = parser ? parser(body) : parse(body);
+        if (metrics != nullptr) {
+            metrics->recordParse(std::chrono::duration<double>(std::chrono::steady_clock::now() - parse_start).count(), body.size());
+        }
+    } catch (...) {
+        error = std::current_exception();
+        current = json();
+        throw;
+    }
+    // agile API tells about the last page explicitly, platform API only provides total
+    bool last;
+    if (envelope.is_last >= 0) {
+        last = envelope.is_last == 1;
+    } else if (envelope.total >= 0) {
+        last = envelope.start_at + envelope.received >= envelope.total;
+    } else {
+        last = envelope.max_results < 0 || envelope.received < envelope.max_results;
+    }
+    if (last || envelope.received == 0) {
+        finished = true;
+    } else {
+        prefetch(envelope.start_at + envelope.received);
+    }
+    return true;
+}
+
+PageEnvelope PageIterator::parse(const std::string& body) {
+    current = json::parse(body);
+    return envelope(current, items_key);
+}
+
+PageEnvelope PageIterator::envelope(const json& page, const std::string& items_key) {
+    PageEnvelope fields;
+    fields.start_at = page.value("startAt", 0);
+    auto items = page.find(items_key);
+    if (items != page.end() && items->is_array()) {
+        fields.received = static_cast<int>(items->size());
+    }
+    if (page.contains("isLast")) {
+        fields.is_last = page.at("isLast").get<bool>() ? 1 : 0;
+    }
+    if (page.contains("total")) {
+        fields.total = page.at("total").get<int>();
+    }
+    if (page.contains("maxResults")) {
+        fields.max_results = page.at("maxResults").get<int>();
+    }
+    return fields;
+}
+
+const json& PageIterator::items() const {
+    static const json empty = json::array();
+    auto found = current.find(items_key);
+    if (found == current.end() || !found->is_array()) {
+        return empty;
+    }
+    return *found;
+}
+
+const json& PageIterator::page() const {
+    return current;
+}
@@ -0,0 +1,244 @@
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+#include "report/report.hpp"
+#include "utils.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    const char* const COLUMNS[] = {
+        "board_id", "sprint_id", "sprint", "start_date", "end_date", "account_id", "person",
+        "subtasks", "issues", "bugs", "others", "story_points", "not_finished",
+        "comments", "comment_lines", "comment_chars", "reviewed"};
+
+    std::vector<std::string> values(const ReportRow& row) {
+        return {
+            std::to_string(row.board_id), std::to_string(row.sprint_id), row.sprint, Utils::timeToString(row.start_date), Utils::timeToString(row.end_date),
+            row.account_id, row.person,
+            std::to_string(row.finished.subtasks), std::to_string(row.finished.issues), std::to_string(row.finished.bugs),
+            std::to_string(row.finished.others), std::to_string(row.finished.story_points), std::to_string(row.not_finished),
+            std::to_string(row.comments), std::to_string(row.comment_lines), std::to_string(row.comment_chars),
+            std::to_string(row.reviewed)};
+    }
+
+    class CsvWriter : public ReportWriter {
+        public:
+            CsvWriter(std::ostream& out, size_t buffer_size) : ReportWriter(out, buffer_size) {}
+
+        protected:
+            void format(const ReportRow& row) override {
+                if (first) {
+                    first = false;
+                    std::string header;
+                    for (const char* column : COLUMNS) {
+                        header += header.empty() ? column : std::string(",") + column;
+                    }
+                    append(header + "\n");
+                }
+                std::string line;
+                for (const auto& value : values(row)) {
+                    if (!line.empty()) {
+                        line.push_back(',');
+                    }
+                    line += quote(value);
+                }
+                append(line + "\n");
+            }
+
+        private:
+            static std::string quote(const std::string& value) {
+                if (value.find_first_of(",\"\r\n") == std::string::npos) {
+                    return value;
+                }
+                std::string quoted = "\"";
+                for (char c : value) {
+                    if (c == '"') {
+                        quoted.push_back('"');
+                    }
+                    quoted.push_back(c);
+                }
+                return quoted + "\"";
+            }
+
+            bool first = true;
+    };
+
+    class JsonLinesWriter : public ReportWriter {
+        public:
+            JsonLinesWriter(std::ostream& out, size_t buffer_size) : ReportWriter(out, buffer_size) {}
+
+        protected:
+            void format(const ReportRow& row) override {
+                json line = {
+                    {"board_id", row.board_id},
+                    {"sprint_id", row.sprint_id},
+                    {"sprint", row.sprint},
+                    {"start_date", Utils::timeToString(row.start_date)},
+                    {"end_date", Utils::timeToString(row.end_date)},
+                    {"account_id", row.account_id},
+                    {"person", row.person},
+                    {"subtasks", row.finished.subtasks},
+                    {"issues", row.finished.issues},
+                    {"bugs", row.finished.bugs},
+                    {"others", row.finished.others},
+                    {"story_points", row.finished.story_points},
+                    {"not_finished", row.not_finished},
+                    {"comments", row.comments},
+                    {"comment_lines", row.comment_lines},
+                    {"comment_chars", row.comment_chars},
+                    {"reviewed", row.reviewed}};
+                append(line.dump() + "\n");
+            }
+    };
+
+    class MarkdownWriter : public ReportWriter {
+        public:
+            MarkdownWriter(std::ostream& out, size_t buffer_size) : ReportWriter(out, buffer_size) {}
+
+        protected:
+            void format(const ReportRow& row) override {
+                if (first || row.sprint_id != sprint_id) {
+                    append((first ? "## " : "\n## ") + escape(row.sprint) + "\n\n"
+                        + Utils::timeToString(row.start_date) + " - " + Utils::timeToString(row.end_date) + "\n\n"
+                        + "| Person | Subtasks | Issues | Bugs | Others | Story Points | Not finished | Comments | Comment lines | Comment characters | Reviewed |\n"
+                        + "|---|--:|--:|--:|--:|--:|--:|--:|--:|--:|--:|\n");
+                }
+                append("| " + escape(row.person)
+                    + " | " + std::to_string(row.finished.subtasks)
+                    + " | " + std::to_string(row.finished.issues)
+                    + " | " + std::to_string(row.finished.bugs)
+                    + " | " + std::to_string(row.finished.others)
+                    + " | " + std::to_string(row.finished.story_points)
+                    + " | " + std::to_string(row.not_finished)
+                    + " | " + std::to_string(row.comments)
+                    + " | " + std::to_string(row.comment_lines)
+                    + " | " + std::to_string(row.comment_chars)
+                    + " | " + std::to_string(row.reviewed) + " |\n");
+                first = false;
+                sprint_id = row.sprint_id;
+            }
+
+        private:
+            static std::string escape(const std::string& text) {
+                std::string escaped;
+                for (char c : text) {
+                    if (c == '|' || c == '\\') {
+                        escaped.push_back('\\');
+                    }
+                    escaped.push_back(c == '\n' ? ' ' : c);
+                }
+                return escaped;
+            }
+
+            bool first = true;
+            int sprint_id = 0;
+    };
+}
+
+std::vector<ReportRow> ReportRow::fromSprint(const JiraSprint& sprint, const std::vector<JiraUser*>& people,
+    const std::vector<PersonalResult*>& results, const std::vector<PersonTally>& tallies) {
+    if (results.size() != people.size() || tallies.size() != people.size()) {
+        throw std::invalid_argument("Results and tallies must be given for every person");
+    }
+    std::vector<ReportRow> rows(people.size());
+    for (size_t i = 0; i < people.size(); i++) {
+        ReportRow& row = rows[i];
+        row.board_id = sprint.board_id;
+        row.sprint_id = sprint.id;
+        row.sprint = sprint.name;
+        row.start_date = sprint.start_date;
+        row.end_date = sprint.end_date;
+        row.account_id = people[i]->id;
+        row.person = people[i]->name;
+        row.finished = tallies[i];
+        row.not_finished = results[i]->not_finished.size();
+        row.comments = results[i]->comments_written.size();
+        for (auto comment : results[i]->comments_written) {
+            row.comment_lines += comment->lines;
+            row.comment_chars += comment->length;
+        }
+        row.reviewed = results[i]->issues_reviwed;
+    }
+    return rows;
+}
+
+std::unique_ptr<ReportWriter> ReportWriter::create(ReportFormat format, std::ostream& out, size_t buffer_size) {
+    switch (format) {
+        case ReportFormat::Csv:
+            return std::unique_ptr<ReportWriter>(new CsvWriter(out, buffer_size));
+        case ReportFormat::JsonLines:
+            return std::unique_ptr<ReportWriter>(new JsonLinesWriter(out, buffer_size));
+        case ReportFormat::Markdown:
+            return std::unique_ptr<ReportWriter>(new MarkdownWriter(out, buffer_size));
+    }
+    throw std::invalid_argument("Unknown report format");
+}
+
+ReportFormat ReportWriter::formatFromName(const std::string& name) {
+    if (name == "csv") {
+        return ReportFormat::Csv;
+    }
+    if (name == "jsonl" || name == "json") {
+        return ReportFormat::JsonLines;
+    }
+    if (name == "markdown" || name == "md") {
+        return ReportFormat::Markdown;
+    }
+    throw std::invalid_argument("Unknown report format: " + name + ". Can be 'csv', 'jsonl' or 'markdown'.");
+}
+
+ReportWriter::ReportWriter(std::ostream& out, size_t buffer_size) : out(out), buffer_size(buffer_size) {
+    buffer.reserve(buffer_size);
+}
+
+ReportWriter::~ReportWriter() {
+    // the stream may be broken already, a destructor must not throw
+    try {
+        finish();
+    } catch (...) {}
+}
+
+void ReportWriter::write(const ReportRow& row) {
+    std::lock_guard<std::mutex> guard(mutex);
+    writeRow(row);
+}
+
+void ReportWriter::writeRow(const ReportRow& row) {
+    format(row);
+    written++;
+}
+
+void ReportWriter::writeSprint(const JiraSprint& sprint, const std::vector<JiraUser*>& people,
+    const std::vector<PersonalResult*>& results, const std::vector<PersonTally>& tallies) {
+    writeRows(ReportRow::fromSprint(sprint, people, results, tallies));
+}
+
+void ReportWriter::writeRows(const std::vector<ReportRow>& rows) {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (const auto& row : rows) {
+        writeRow(row);
+    }
+}
+
+void ReportWriter::finish() {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!buffer.empty()) {
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    out.flush();
+}
+
+size_t ReportWriter::rows() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return written;
+}
+
+void ReportWriter::append(const std::string& text) {
+    if (buffer.size() + text.size() > buffer_size && !buffer.empty()) {
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    buffer += text;
+}
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include "jira/scheduler.hpp"
+#include "logging.hpp"
+
+auto scheduler_logger = makeLogger("Jira Scheduler");
+
+namespace {
+    bool isTransient(long status_code) {
+        return status_code == 0 || status_code == 429 || status_code == 500 || status_code == 502 || status_code == 503 || status_code == 504;
+    }
+
+    // the server asks to slow down
+    bool isOverloaded(long status_code) {
+        return status_code == 429 || status_code == 503;
+    }
+}
+
+RequestScheduler::RequestScheduler(Transport& transport, const SchedulerOptions options, Metrics* metrics)
+    : transport(transport), metrics(metrics), requests(0), throttled(0), retried(0), failed(0) {
+    setOptions(options);
+    refilled_at = Clock::now();
+    paused_until = refilled_at;
+}
+
+void RequestScheduler::setOptions(const SchedulerOptions options) {
+    if (options.requests_per_second <= 0 || options.burst < 1 || options.min_concurrency == 0 || options.min_concurrency > options.max_concurrency) {
+        throw std::invalid_argument("Incorrect scheduler options");
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    this->options = options;
+    tokens = options.burst;
+    // slow start: the limit grows while the server keeps up
+    concurrency = static_cast<double>(options.min_concurrency);
+    slot_released.notify_all();
+}
+
+SchedulerStats RequestScheduler::stats() const {
+    SchedulerStats stats;
+    stats.requests = requests;
+    stats.throttled = throttled;
+    stats.retried = retried;
+    stats.failed = failed;
+    std::lock_guard<std::mutex> guard(mutex);
+    stats.concurrency = concurrency;
+    return stats;
+}
+
+HttpResponse RequestScheduler::get(const std::string& url, const std::map<std::string, std::string>& params) {
+    for (size_t attempt = 0;; attempt++) {
+        HttpResponse response;
+        {
+            Slot slot(*this);
+            requests++;
+            response = transport.get(url, params);
+            slot.overloaded = isOverloaded(response.status_code);
+        }
+        if (metrics != nullptr) {
+            metrics->recordRequest(url, response.status_code, response.elapsed, response.text.size());
+        }
+        if (!isTransient(response.status_code)) {
+            return response;
+        }
+        if (attempt >= options.max_retries) {
+            failed++;
+            scheduler_logger->error("Request to {} failed after {} retries with code {} {}", url, attempt, response.status_code, response.error);
+            return response;
+        }
+        double delay = backoff(attempt);
+        // throttling always pauses everything, an overloaded server only when it says for how long
+        bool shared = response.status_code == 429;
+        if (response.status_code == 429) {
+            throttled++;
+        }
+        if (isOverloaded(response.status_code)) {
+            auto header = response.headers.find("retry-after");
+            if (header != response.headers.end()) {
+                double requested = retryAfter(header->second, time(nullptr));
+                if (requested >= 0) {
+                    // a far date in the header must not stop the client for hours
+                    delay = std::min(requested, options.max_backoff);
+                    shared = true;
+                }
+            }
+        }
+        if (shared) {
+            // the limit is shared by all requests, so all of them wait
+            pause(delay);
+            scheduler_logger->warn("Jira returned {}, requests are paused for {:.1f}s", response.status_code, delay);
+        } else {
+            scheduler_logger->warn("Request to {} returned {}, retry in {:.1f}s", url, response.status_code, delay);
+            std::this_thread::sleep_for(std::chrono::duration<double>(delay));
+        }
+        retried++;
+    }
+}
+
+RequestScheduler::Slot::Slot(RequestScheduler& scheduler) : scheduler(scheduler) {
+    scheduler.acquire();
+}
+
+RequestScheduler::Slot::~Slot() {
+    scheduler.release(overloaded);
+}
+
+void RequestScheduler::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    slot_released.wait(lock, [this]() { return in_flight < static_cast<size_t>(concurrency); });
+    in_flight++;
+    // take a token, sleeping outside of the lock while the bucket is empty or requests are paused
+    for (;;) {
+        Clock::time_point now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - refilled_at).count();
+        tokens = std::min(options.burst, tokens + elapsed * options.requests_per_second);
+        refilled_at = now;
+        Clock::duration wait = Clock::duration::zero();
+        if (now < paused_until) {
+            wait = paused_until - now;
+        } else if (tokens >= 1) {
+            tokens -= 1;
+            return;
+        } else {
+            wait = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>((1 - tokens) / options.requests_per_second));
+        }
+        lock.unlock();
+        std::this_thread::sleep_for(wait);
+        lock.lock();
+    }
+}
+
+void RequestScheduler::release(bool overloaded) {
+    std::lock_guard<std::mutex> guard(mutex);
+    in_flight--;
+    if (overloaded) {
+        concurrency = std::max(static_cast<double>(options.min_concurrency), concurrency / 2);
+    } else {
+        // +1 after `concurrency` successful requests, i.e. one round
+        concurrency = std::min(static_cast<double>(options.max_concurrency), concurrency + 1 / concurrency);
+    }
+    slot_released.notify_all();
+}
+
+void RequestScheduler::pause(double seconds) {
+    std::lock_guard<std::mutex> guard(mutex);
+    Clock::time_point until = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    paused_until = std::max(paused_until, until);
+    // burst is not allowed right after the pause
+    tokens = 0;
+}
+
+double RequestScheduler::backoff(size_t attempt) const {
+    // random delay between a half and the whole exponential limit, so retries of parallel requests are spread
+    static thread_local std::mt19937 generator(std::random_device{}());
+    double limit = std::min(options.max_backoff, options.base_backoff * static_cast<double>(1ull << std::min<size_t>(attempt, 20)));
+    return std::uniform_real_distribution<double>(limit / 2, limit)(generator);
+}
+
+double RequestScheduler::retryAfter(const std::string& value, time_t now) {
+    if (!value.empty() && std::all_of(value.begin(), value.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+        return std::stod(value);
+    }
+    // HTTP date, e.g. "Wed, 21 Oct 2015 07:28:00 GMT"
+    std::tm date = {};
+    const char* end = strptime(value.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &date);
+    if (end == nullptr || *end != '\0') {
+        return -1;
+    }
+    return std::max(0.0, difftime(timegm(&date), now));
+}
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cctype>
+#include <cpr/cpr.h>
+#include <curl/curl.h>
+
+#include "jira/session_pool.hpp"
+
+/**
+ * Data shared by all sessions of the pool: DNS cache and TLS sessions.
+ * libcurl requires explicit locking when the share handle is used from several threads.
+ */
+struct SessionPool::SharedData {
+    CURLSH* handle;
+    std::mutex locks[CURL_LOCK_DATA_LAST];
+
+    SharedData() {
+        handle = curl_share_init();
+        curl_share_setopt(handle, CURLSHOPT_LOCKFUNC, &SharedData::lock);
+        curl_share_setopt(handle, CURLSHOPT_UNLOCKFUNC, &SharedData::unlock);
+        curl_share_setopt(handle, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    ~SharedData() {
+        curl_share_cleanup(handle);
+    }
+
+    static void lock(CURL*, curl_lock_data data, curl_lock_access, void* user_data) {
+        static_cast<SharedData*>(user_data)->locks[data].lock();
+    }
+
+    static void unlock(CURL*, curl_lock_data data, void* user_data) {
+        static_cast<SharedData*>(user_data)->locks[data].unlock();
+    }
+};
+
+SessionPool::SessionPool(const std::string username, const std::string api_token, const SessionOptions options) {
+    this->user = username;
+    this->token = api_token;
+    this->options = options;
+    this->shared = std::unique_ptr<SharedData>(new SharedData());
+}
+
+SessionPool::~SessionPool() {
+    // sessions have to be closed before the share handle they use
+    idle.clear();
+}
+
+size_t SessionPool::opened() const {
+    std::lock_guard<std::mutex> guard(idle_mutex);
+    return opened_count;
+}
+
+std::unique_ptr<cpr::Session> SessionPool::acquire() {
+    {
+        std::lock_guard<std::mutex> guard(idle_mutex);
+        if (!idle.empty()) {
+            std::unique_ptr<cpr::Session> session = std::move(idle.back());
+            idle.pop_back();
+            return session;
+        }
+        opened_count++;
+    }
+    std::unique_ptr<cpr::Session> session(new cpr::Session());
+    session->SetAuth(cpr::Authentication(user, token));
+    session->SetTimeout(cpr::Timeout{static_cast<std::int32_t>(options.timeout_ms)});
+    session->SetHeader(cpr::Header{{"Accept", "application/json"}});
+    CURL* curl = session->GetCurlHolder()->handle;
+    curl_easy_setopt(curl, CURLOPT_SHARE, shared->handle);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    if (options.compression) {
+        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "gzip, deflate");
+    }
+    if (options.http2) {
+        // every session has its own connection, so this is negotiation only: streams are not multiplexed
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    }
+    return session;
+}
+
+void SessionPool::release(std::unique_ptr<cpr::Session> session) {
+    std::lock_guard<std::mutex> guard(idle_mutex);
+    if (idle.size() < options.max_idle) {
+        idle.push_back(std::move(session));
+    }
+}
+
+HttpResponse SessionPool::get(const std::string& url, const std::map<std::string, std::string>& params) {
+    std::unique_ptr<cpr::Session> session = acquire();
+    CURL* curl = session->GetCurlHolder()->handle;
+    std::string full_url = url;
+    char separator = '?';
+    for (const auto& param : params) {
+        char* key = curl_easy_escape(curl, param.first.c_str(), static_cast<int>(param.first.length()));
+        char* value = curl_easy_escape(curl, param.second.c_str(), static_cast<int>(param.second.length()));
+        full_url += separator;
+        full_url += key;
+        full_url += '=';
+        full_url += value;
+        separator = '&';
+        curl_free(key);
+        curl_free(value);
+    }
+    session->SetUrl(cpr::Url{full_url});
+    cpr::Response response = session->Get();
+
+    HttpResponse result;
+    result.status_code = response.status_code;
+    result.text = std::move(response.text);
+    result.elapsed = response.elapsed;
+    result.error = response.error.message;
+    for (const auto& header : response.header) {
+        std::string name = header.first;
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+        result.headers[name] = header.second;
+    }
+    // broken connections are not returned into the pool
+    if (response.status_code != 0) {
+        release(std::move(session));
+    }
+    return result;
+}
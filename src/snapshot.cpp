@@ -0,0 +1,357 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "jira/snapshot.hpp"
+
+namespace {
+    const char MAGIC[8] = {'J', 'I', 'R', 'A', 'S', 'N', 'A', 'P'};
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    static_assert(sizeof(SnapshotHeader) == 80, "Snapshot header layout is a part of the file format");
+    static_assert(sizeof(SnapshotSprint) == 56, "Snapshot sprint layout is a part of the file format");
+    static_assert(sizeof(SnapshotIssue) == 96, "Snapshot issue layout is a part of the file format");
+    static_assert(sizeof(SnapshotComment) == 56, "Snapshot comment layout is a part of the file format");
+
+    bool knownType(int32_t type) {
+        switch (type) {
+        case Epic:
+        case Bug:
+        case Task:
+        case Story:
+        case Subtask:
+        case Debt:
+        case Improvement:
+        case NewFeature:
+        case Support:
+        case Enabler:
+        case Test:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void checkRange(uint64_t first, uint64_t count, uint64_t total) {
+        if (first > total || count > total - first) {
+            throw std::runtime_error("Snapshot record refers outside of its section");
+        }
+    }
+
+    size_t aligned(size_t offset) {
+        return (offset + 7) & ~static_cast<size_t>(7);
+    }
+
+    template <class T>
+    void writeSection(std::ofstream& file, const std::vector<T>& records, uint64_t offset) {
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+    }
+}
+
+SnapshotString SnapshotWriter::string(const std::string& value) {
+    auto found = known_strings.find(value);
+    if (found != known_strings.end()) {
+        return found->second;
+    }
+    if (strings.size() + value.size() + 1 > UINT32_MAX) {
+        throw std::length_error("Snapshot string table is too big");
+    }
+    SnapshotString reference = {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size())};
+    strings.append(value);
+    strings.push_back('\0');
+    known_strings.insert({value, reference});
+    return reference;
+}
+
+void SnapshotWriter::add(const JiraSprint& sprint) {
+    SnapshotSprint record = {};
+    record.id = sprint.id;
+    record.board_id = sprint.board_id;
+    record.start_date = sprint.start_date;
+    record.end_date = sprint.end_date;
+    record.complete_date = sprint.complete_date;
+    record.name = string(sprint.name);
+    record.first_issue = static_cast<uint32_t>(issues.size());
+    record.issue_count = static_cast<uint32_t>(sprint.issues.size());
+    record.closed = sprint.is_closed ? 1 : 0;
+    sprints.push_back(record);
+    for (auto issue : sprint.issues) {
+        SnapshotIssue issue_record = {};
+        issue_record.id = string(issue->id);
+        issue_record.key = string(issue->key);
+        issue_record.title = string(issue->title);
+        issue_record.parent_id = string(issue->parent_id);
+        issue_record.status_id = string(issue->status.id);
+        issue_record.status_name = string(issue->status.name);
+        issue_record.assignee = string(AccountIndex::accountId(issue->assignee));
+        issue_record.resolution_date = issue->resolution_date;
+        issue_record.type = issue->type;
+        issue_record.story_points = issue->story_points;
+        issue_record.first_comment = static_cast<uint32_t>(comments.size());
+        issue_record.comment_count = static_cast<uint32_t>(issue->comments.size());
+        issue_record.first_subtask = static_cast<uint32_t>(subtasks.size());
+        issue_record.subtask_count = static_cast<uint32_t>(issue->subtasks_ids.size());
+        issue_record.resolved = issue->resolved ? 1 : 0;
+        issues.push_back(issue_record);
+        for (const auto& comment : issue->comments) {
+            SnapshotComment comment_record = {};
+            comment_record.id = string(comment.id);
+            comment_record.author = string(AccountIndex::accountId(comment.author));
+            comment_record.text = string(comment.text);
+            comment_record.preview = string(comment.preview);
+            comment_record.published_date = comment.published_date;
+            comment_record.length = comment.length;
+            comment_record.lines = comment.lines;
+            comments.push_back(comment_record);
+        }
+        for (const auto& subtask_id : issue->subtasks_ids) {
+            subtasks.push_back(string(subtask_id));
+        }
+    }
+}
+
+void SnapshotWriter::save(const std::string& path) const {
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.sprint_count = static_cast<uint32_t>(sprints.size());
+    header.issue_count = static_cast<uint32_t>(issues.size());
+    header.comment_count = static_cast<uint32_t>(comments.size());
+    header.subtask_count = static_cast<uint32_t>(subtasks.size());
+    header.sprints_offset = aligned(sizeof(SnapshotHeader));
+    header.issues_offset = aligned(header.sprints_offset + sprints.size() * sizeof(SnapshotSprint));
+    header.comments_offset = aligned(header.issues_offset + issues.size() * sizeof(SnapshotIssue));
+    header.subtasks_offset = aligned(header.comments_offset + comments.size() * sizeof(SnapshotComment));
+    header.strings_offset = aligned(header.subtasks_offset + subtasks.size() * sizeof(SnapshotString));
+    header.strings_size = strings.size();
+    std::string temporary = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeSection(file, sprints, header.sprints_offset);
+        writeSection(file, issues, header.issues_offset);
+        writeSection(file, comments, header.comments_offset);
+        writeSection(file, subtasks, header.subtasks_offset);
+        file.seekp(header.strings_offset);
+        file.write(strings.data(), strings.size());
+        if (!file.good()) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Cannot write snapshot file: " + temporary);
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Cannot replace snapshot file: " + path);
+    }
+}
+
+SnapshotView::SnapshotView(const std::string path) {
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw std::runtime_error("Cannot open snapshot file: " + path);
+    }
+    struct stat info;
+    if (fstat(file, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+        close(file);
+        throw std::runtime_error("Snapshot file is too small: " + path);
+    }
+    size = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    // the mapping stays valid after the descriptor is closed
+    close(file);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Cannot map snapshot file: " + path);
+    }
+    base = static_cast<const char*>(mapped);
+    header = reinterpret_cast<const SnapshotHeader*>(base);
+    try {
+        validate();
+    } catch (const std::runtime_error& error) {
+        munmap(const_cast<char*>(base), size);
+        throw std::runtime_error(std::string(error.what()) + ": " + path);
+    }
+    sprint_records = reinterpret_cast<const SnapshotSprint*>(base + header->sprints_offset);
+    issue_records = reinterpret_cast<const SnapshotIssue*>(base + header->issues_offset);
+    comment_records = reinterpret_cast<const SnapshotComment*>(base + header->comments_offset);
+    subtask_records = reinterpret_cast<const SnapshotString*>(base + header->subtasks_offset);
+    strings = base + header->strings_offset;
+}
+
+SnapshotView::~SnapshotView() {
+    munmap(const_cast<char*>(base), size);
+}
+
+void SnapshotView::validate() const {
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a snapshot file");
+    }
+    if (header->version != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(header->version));
+    }
+    if (header->byte_order != BYTE_ORDER_MARK) {
+        throw std::runtime_error("Snapshot was written with another byte order");
+    }
+    auto section = [this](uint64_t offset, uint64_t count, uint64_t record_size) {
+        if (offset % 8 != 0 || offset > size || count > (size - offset) / record_size) {
+            throw std::runtime_error("Snapshot section is outside of the file");
+        }
+    };
+    section(header->sprints_offset, header->sprint_count, sizeof(SnapshotSprint));
+    section(header->issues_offset, header->issue_count, sizeof(SnapshotIssue));
+    section(header->comments_offset, header->comment_count, sizeof(SnapshotComment));
+    section(header->subtasks_offset, header->subtask_count, sizeof(SnapshotString));
+    section(header->strings_offset, header->strings_size, 1);
+    // records are checked by the accessors when they are read, so opening doesn't depend on the size of the file
+}
+
+void SnapshotView::checkString(const SnapshotString& value) const {
+    const char* table = base + header->strings_offset;
+    if (value.offset >= header->strings_size || value.size > header->strings_size - value.offset - 1
+        || table[value.offset + value.size] != '\0') {
+        throw std::runtime_error("Snapshot string is outside of the string table");
+    }
+}
+
+size_t SnapshotView::sprintCount() const {
+    return header->sprint_count;
+}
+
+size_t SnapshotView::issueCount() const {
+    return header->issue_count;
+}
+
+const SnapshotSprint& SnapshotView::sprint(size_t index) const {
+    if (index >= header->sprint_count) {
+        throw std::out_of_range("No sprint " + std::to_string(index) + " in the snapshot");
+    }
+    const SnapshotSprint& record = sprint_records[index];
+    checkRange(record.first_issue, record.issue_count, header->issue_count);
+    return record;
+}
+
+int SnapshotView::findSprint(int sprint_id) const {
+    for (uint32_t i = 0; i < header->sprint_count; i++) {
+        if (sprint_records[i].id == sprint_id) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+const SnapshotIssue& SnapshotView::issue(size_t index) const {
+    if (index >= header->issue_count) {
+        throw std::out_of_range("No issue " + std::to_string(index) + " in the snapshot");
+    }
+    const SnapshotIssue& record = issue_records[index];
+    checkRange(record.first_comment, record.comment_count, header->comment_count);
+    checkRange(record.first_subtask, record.subtask_count, header->subtask_count);
+    if (!knownType(record.type)) {
+        throw std::runtime_error("Snapshot issue has unknown type " + std::to_string(record.type));
+    }
+    return record;
+}
+
+const SnapshotComment& SnapshotView::comment(size_t index) const {
+    if (index >= header->comment_count) {
+        throw std::out_of_range("No comment " + std::to_string(index) + " in the snapshot");
+    }
+    return comment_records[index];
+}
+
+const SnapshotString& SnapshotView::subtask(size_t index) const {
+    if (index >= header->subtask_count) {
+        throw std::out_of_range("No subtask " + std::to_string(index) + " in the snapshot");
+    }
+    return subtask_records[index];
+}
+
+const char* SnapshotView::data(const SnapshotString& value) const {
+    checkString(value);
+    return strings + value.offset;
+}
+
+std::string SnapshotView::string(const SnapshotString& value) const {
+    checkString(value);
+    return std::string(strings + value.offset, value.size);
+}
+
+SprintColumns SnapshotView::columns(size_t index) const {
+    const SnapshotSprint& record = sprint(index);
+    SprintColumns columns;
+    columns.category.reserve(record.issue_count);
+    columns.story_points.reserve(record.issue_count);
+    columns.assignee.reserve(record.issue_count);
+    columns.resolved.reserve(record.issue_count);
+    columns.resolution_date.reserve(record.issue_count);
+    // equal strings share an offset, so every account is interned once
+    std::unordered_map<uint32_t, AccountHandle> handles;
+    for (uint32_t i = record.first_issue; i < record.first_issue + record.issue_count; i++) {
+        const SnapshotIssue& issue = this->issue(i);
+        AccountHandle assignee = NO_ACCOUNT;
+        if (issue.assignee.size > 0) {
+            auto found = handles.find(issue.assignee.offset);
+            if (found == handles.end()) {
+                found = handles.insert({issue.assignee.offset, AccountIndex::intern(string(issue.assignee))}).first;
+            }
+            assignee = found->second;
+        }
+        columns.category.push_back(SprintColumns::categorize(static_cast<IssueType>(issue.type)));
+        columns.story_points.push_back(issue.story_points);
+        columns.assignee.push_back(assignee);
+        columns.resolved.push_back(issue.resolved);
+        columns.resolution_date.push_back(issue.resolution_date);
+    }
+    return columns;
+}
+
+JiraSprint* SnapshotView::toSprint(size_t index, JiraArena* arena) const {
+    const SnapshotSprint& record = sprint(index);
+    JiraSprint* sprint = arena != nullptr ? arena->sprints.create() : new JiraSprint();
+    sprint->id = record.id;
+    sprint->board_id = record.board_id;
+    sprint->name = string(record.name);
+    sprint->start_date = static_cast<time_t>(record.start_date);
+    sprint->end_date = static_cast<time_t>(record.end_date);
+    sprint->complete_date = static_cast<time_t>(record.complete_date);
+    sprint->is_closed = record.closed != 0;
+    sprint->issues.reserve(record.issue_count);
+    for (uint32_t i = record.first_issue; i < record.first_issue + record.issue_count; i++) {
+        const SnapshotIssue& issue_record = this->issue(i);
+        JiraIssue* issue = arena != nullptr ? arena->issues.create() : new JiraIssue();
+        issue->id = string(issue_record.id);
+        issue->key = string(issue_record.key);
+        issue->title = string(issue_record.title);
+        issue->parent_id = string(issue_record.parent_id);
+        issue->status = IssueStatus{string(issue_record.status_id), string(issue_record.status_name)};
+        issue->assignee = AccountIndex::intern(string(issue_record.assignee));
+        issue->type = static_cast<IssueType>(issue_record.type);
+        issue->story_points = issue_record.story_points;
+        issue->resolved = issue_record.resolved != 0;
+        issue->resolution_date = static_cast<time_t>(issue_record.resolution_date);
+        issue->comments.resize(issue_record.comment_count);
+        for (uint32_t c = 0; c < issue_record.comment_count; c++) {
+            const SnapshotComment& comment_record = this->comment(issue_record.first_comment + c);
+            Comment& comment = issue->comments[c];
+            comment.id = string(comment_record.id);
+            comment.author = AccountIndex::intern(string(comment_record.author));
+            comment.text = string(comment_record.text);
+            comment.preview = string(comment_record.preview);
+            comment.published_date = static_cast<time_t>(comment_record.published_date);
+            comment.length = static_cast<size_t>(comment_record.length);
+            comment.lines = static_cast<size_t>(comment_record.lines);
+        }
+        issue->subtasks_ids.reserve(issue_record.subtask_count);
+        for (uint32_t s = 0; s < issue_record.subtask_count; s++) {
+            issue->subtasks_ids.push_back(string(this->subtask(issue_record.first_subtask + s)));
+        }
+        sprint->issues.push_back(issue);
+    }
+    return sprint;
+}
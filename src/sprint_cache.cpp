@@ -0,0 +1,70 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "jira/sprint_cache.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    void makeDirectory(const std::string& path) {
+        if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+            throw std::runtime_error("Cannot create cache directory: " + path);
+        }
+    }
+
+    // unique part of temporary file names, sprints can be stored from several threads
+    std::atomic<unsigned> temporary_files(0);
+}
+
+SprintCache::SprintCache(const std::string directory) {
+    this->root = directory;
+    if (!this->root.empty() && this->root.back() == '/') {
+        this->root.pop_back();
+    }
+    makeDirectory(this->root);
+}
+
+const std::string& SprintCache::directory() const {
+    return root;
+}
+
+bool SprintCache::load(int board_id, int sprint_id, CachedSprint& entry) const {
+    std::ifstream file(root + "/board-" + std::to_string(board_id) + "/sprint-" + std::to_string(sprint_id) + ".json");
+    if (!file.is_open()) {
+        return false;
+    }
+    json data = json::parse(file, nullptr, false);
+    if (data.is_discarded() || !data.is_object()) {
+        return false;
+    }
+    entry.closed = data.value("closed", false);
+    entry.synced_at = data.value("synced_at", (time_t)0);
+    entry.query = data.value("query", std::string());
+    entry.issues = std::move(data["issues"]);
+    return entry.issues.is_array();
+}
+
+void SprintCache::store(int board_id, int sprint_id, const CachedSprint& entry) const {
+    std::string board_directory = root + "/board-" + std::to_string(board_id);
+    makeDirectory(board_directory);
+    std::string path = board_directory + "/sprint-" + std::to_string(sprint_id) + ".json";
+    std::string temporary = path + "." + std::to_string(getpid()) + "-" + std::to_string(temporary_files++) + ".tmp";
+    {
+        json data = {
+            {"closed", entry.closed},
+            {"synced_at", entry.synced_at},
+            {"query", entry.query},
+            {"issues", entry.issues}};
+        std::ofstream file(temporary);
+        file << data.dump();
+        if (!file.good()) {
+            throw std::runtime_error("Cannot write cache file: " + temporary);
+        }
+    }
+    std::rename(temporary.c_str(), path.c_str());
+}
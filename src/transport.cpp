@@ -0,0 +1,98 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+#include "jira/transport.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    // FNV-1a, stable between runs and platforms unlike std::hash
+    uint64_t fingerprint(const std::string& text) {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : text) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::atomic<unsigned> temporary_files(0);
+}
+
+CprTransport::CprTransport(const std::string username, const std::string api_token, const SessionOptions options)
+    : pool(username, api_token, options) {}
+
+HttpResponse CprTransport::get(const std::string& url, const std::map<std::string, std::string>& params) {
+    return pool.get(url, params);
+}
+
+ReplayTransport::ReplayTransport(const std::string directory, Mode mode, std::shared_ptr<Transport> upstream) {
+    this->directory = directory;
+    this->mode = mode;
+    this->upstream = upstream;
+    if (mode == Mode::Record) {
+        if (!upstream) {
+            throw std::invalid_argument("Upstream transport is required for recording");
+        }
+        if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+            throw std::runtime_error("Cannot create directory for recorded responses: " + directory);
+        }
+    }
+}
+
+std::string ReplayTransport::path(const std::string& url, const std::map<std::string, std::string>& params) const {
+    // parameters are sorted by std::map, so the key doesn't depend on their order
+    std::string request = url;
+    for (const auto& param : params) {
+        request += "\n" + param.first + "=" + param.second;
+    }
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(fingerprint(request)));
+    return directory + "/" + name + ".json";
+}
+
+HttpResponse ReplayTransport::get(const std::string& url, const std::map<std::string, std::string>& params) {
+    std::string file_path = path(url, params);
+    HttpResponse response;
+    if (mode == Mode::Replay) {
+        std::ifstream file(file_path);
+        json recorded = json::parse(file, nullptr, false);
+        if (!file.is_open() || recorded.is_discarded()) {
+            // a missing response won't appear on retry, so it is not reported as a network error
+            response.status_code = 404;
+            response.error = "No recorded response for " + url;
+            return response;
+        }
+        response.status_code = recorded.at("status_code").get<long>();
+        response.headers = recorded.at("headers").get<std::map<std::string, std::string>>();
+        response.text = recorded.at("text").get<std::string>();
+        return response;
+    }
+    response = upstream->get(url, params);
+    if (response.status_code == 0) {
+        // transport errors are not recorded, they are not a part of the server's behaviour
+        return response;
+    }
+    json recorded = {
+        {"url", url},
+        {"params", params},
+        {"status_code", response.status_code},
+        {"headers", response.headers},
+        {"text", response.text}};
+    std::string temporary = file_path + "." + std::to_string(getpid()) + "-" + std::to_string(temporary_files++) + ".tmp";
+    {
+        std::ofstream file(temporary);
+        file << recorded.dump(2);
+        if (!file.good()) {
+            throw std::runtime_error("Cannot write recorded response: " + temporary);
+        }
+    }
+    std::rename(temporary.c_str(), file_path.c_str());
+    return response;
+}
@@ -1,94 +1,557 @@
 #include <string>
 #include <nlohmann/json.hpp>
-#include <spdlog/spdlog.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
+#ifdef JIRA_USE_SIMDJSON
+#include <simdjson.h>
+#endif
 
 #include "jira/types.hpp"
+#include "jira/arena.hpp"
+#include "jira/executor.hpp"
+#include "jira/pagination.hpp"
 #include "utils.hpp"
+#include "logging.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 using json = nlohmann::json;
 
-auto types_logger = spdlog::stdout_color_mt("Jira Types Parser");
+auto types_logger = makeLogger("Jira Types Parser");
+
+namespace {
+    struct AccountTable {
+        std::mutex mutex;
+        std::deque<std::string> ids;    // handle - 1 -> id, deque keeps references valid
+        std::unordered_map<std::string, AccountHandle> handles;
+    };
+
+    AccountTable& accounts() {
+        static AccountTable table;
+        return table;
+    }
+
+    // Measures a comment body piece by piece without building the whole text
+    class CommentText {
+        public:
+            CommentText(Comment& comment, const ParseOptions& options)
+                : comment(comment), keep_text(options.comments == CommentMode::Full), preview_left(options.preview_length) {}
+
+            void append(const std::string& text) {
+                append(text.data(), text.size());
+            }
+
+            void append(const char* text, size_t size) {
+                for (const char* end = text + size; text != end; ++text) {
+                    char c = *text;
+                    if (c == '\n') {
+                        breakLine();
+                        continue;
+                    }
+                    line_open = true;
+                    // UTF-8 continuation bytes don't start a new character
+                    bool continuation = (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+                    if (!continuation) {
+                        comment.length++;
+                        if (preview_left > 0 && pending_space) {
+                            comment.preview.push_back(' ');
+                            preview_left--;
+                        }
+                        pending_space = false;
+                        preview_open = preview_left > 0;
+                        if (preview_open) {
+                            preview_left--;
+                        }
+                    }
+                    if (preview_open) {
+                        comment.preview.push_back(c);
+                    }
+                    if (keep_text) {
+                        comment.text.push_back(c);
+                    }
+                }
+            }
+
+            void breakLine() {
+                if (line_open) {
+                    comment.lines++;
+                    pending_space = !comment.preview.empty();
+                }
+                line_open = false;
+            }
+
+            // Atlassian Document Format: text is in "text" nodes, blocks are separate lines
+            void appendDocument(const json& node) {
+                auto type = node.find("type");
+                if (type == node.end() || !type->is_string()) {
+                    return;
+                }
+                const std::string& name = type->get_ref<const std::string&>();
+                if (name == "text") {
+                    append(node.value("text", std::string()));
+                } else if (name == "hardBreak") {
+                    breakLine();
+                } else if (name == "mention" || name == "emoji") {
+                    auto attributes = node.find("attrs");
+                    if (attributes != node.end()) {
+                        append(attributes->value("text", std::string()));
+                    }
+                }
+                auto content = node.find("content");
+                if (content != node.end() && content->is_array()) {
+                    for (const auto& child : *content) {
+                        appendDocument(child);
+                    }
+                }
+                if (name == "paragraph" || name == "heading" || name == "codeBlock") {
+                    breakLine();
+                }
+            }
+
+#ifdef JIRA_USE_SIMDJSON
+            // Same walk over a simdjson document
+            void appendDocument(const simdjson::dom::element& node) {
+                std::string_view name;
+                if (node["type"].get(name) != simdjson::SUCCESS) {
+                    return;
+                }
+                if (name == "text") {
+                    appendField(node, "text");
+                } else if (name == "hardBreak") {
+                    breakLine();
+                } else if (name == "mention" || name == "emoji") {
+                    simdjson::dom::element attributes;
+                    if (node["attrs"].get(attributes) == simdjson::SUCCESS) {
+                        appendField(attributes, "text");
+                    }
+                }
+                simdjson::dom::array content;
+                if (node["content"].get(content) == simdjson::SUCCESS) {
+                    for (simdjson::dom::element child : content) {
+                        appendDocument(child);
+                    }
+                }
+                if (name == "paragraph" || name == "heading" || name == "codeBlock") {
+                    breakLine();
+                }
+            }
+
+            // missing field is an empty text, a field of another type is an error
+            void appendField(const simdjson::dom::element& node, const char* key) {
+                simdjson::dom::element value;
+                if (node[key].get(value) == simdjson::SUCCESS) {
+                    std::string_view text = value.get_string();
+                    append(text.data(), text.size());
+                }
+            }
+#endif
+
+        private:
+            Comment& comment;
+            bool keep_text;
+            size_t preview_left;
+            bool line_open = false;
+            bool preview_open = false;
+            bool pending_space = false;
+    };
+}
+
+namespace {
+    // Fills issues[first, first + count) with map(index), tasks of `chunk` issues run on the executor
+    template <class F>
+    void mapIssues(std::vector<JiraIssue*>& issues, size_t count, size_t chunk, Executor* executor, F map) {
+        size_t first = issues.size();
+        issues.resize(first + count);
+        JiraIssue** target = issues.data() + first;
+        chunk = std::max<size_t>(chunk, 1);
+        if (executor == nullptr || count <= chunk) {
+            for (size_t i = 0; i < count; i++) {
+                target[i] = map(i);
+            }
+            return;
+        }
+        std::vector<std::future<void>> tasks;
+        for (size_t begin = chunk; begin < count; begin += chunk) {
+            size_t end = std::min(count, begin + chunk);
+            tasks.push_back(executor->submit([target, begin, end, &map]() {
+                for (size_t i = begin; i < end; i++) {
+                    target[i] = map(i);
+                }
+            }));
+        }
+        // the first chunk is mapped here, then the thread helps with the rest
+        std::exception_ptr error;
+        try {
+            for (size_t i = 0; i < chunk; i++) {
+                target[i] = map(i);
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        // tasks use `map`, so all of them are finished before an error is thrown
+        for (auto& task : tasks) {
+            executor->wait(task);
+            try {
+                task.get();
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            issues.resize(first);
+            std::rethrow_exception(error);
+        }
+    }
+
+#ifdef JIRA_USE_SIMDJSON
+    typedef simdjson::dom::element Element;
+
+    std::string text(const Element& value) {
+        std::string_view view = value.get_string().value();
+        return std::string(view.data(), view.size());
+    }
+
+    // missing and null fields are treated alike
+    bool present(const Element& object, const char* key, Element& value) {
+        return object[key].get(value) == simdjson::SUCCESS && !value.is_null();
+    }
+
+    int number(const Element& value) {
+        switch (value.type()) {
+            case simdjson::dom::element_type::INT64:
+                return static_cast<int>(value.get_int64().value());
+            case simdjson::dom::element_type::UINT64:
+                return static_cast<int>(value.get_uint64().value());
+            default:
+                return static_cast<int>(value.get_double().value());
+        }
+    }
+
+    // The same mapping as JiraIssue::fromJSON(), missing required fields throw simdjson_error
+    JiraIssue* issueFromElement(const Element& json_data, JiraArena* arena, const ParseOptions& options) {
+        JiraIssue *issue = arena != nullptr ? arena->issues.create() : new JiraIssue();
+        issue->id = text(json_data["id"]);
+        issue->key = text(json_data["key"]);
+        Element fields = json_data["fields"];
+        Element found;
+        if (present(fields, STORY_POINTS_FIELD.c_str(), found)) {
+            issue->story_points = number(found);
+        }
+        Element issue_type = fields["issuetype"];
+        if (issue_type["subtask"].get_bool().value()) {
+            issue->type = IssueType::Subtask;
+        } else {
+            issue->type = static_cast<IssueType>(stoi(text(issue_type["id"])));
+        }
+        if (present(fields, "assignee", found)) {
+            issue->assignee = AccountIndex::intern(text(found["accountId"]));
+        }
+        issue->title = text(fields["summary"]);
+        Element status = fields["status"];
+        issue->status = IssueStatus{text(status["id"]), text(status["name"])};
+        // a missing resolution (e.g. not in the requested fields) means not resolved, like null
+        if (present(fields, "resolution", found)) {
+            issue->resolved = true;
+            std::string_view resolution_date = fields["resolutiondate"].get_string();
+            issue->resolution_date = Utils::parseTimestapm(resolution_date.data(), resolution_date.size());
+        }
+        if (fields["parent"].get(found) == simdjson::SUCCESS) {
+            issue->parent_id = text(found["id"]);
+        }
+        Element comments;
+        if (fields["comment"].get(found) == simdjson::SUCCESS && !(comments = found["comments"].value()).is_null()) {
+            simdjson::dom::array list = comments.get_array().value();
+            issue->comments.reserve(list.size());
+            for (Element json_comment : list) {
+                issue->comments.emplace_back();
+                Comment& comment = issue->comments.back();
+                comment.id = text(json_comment["id"]);
+                comment.author = AccountIndex::intern(text(json_comment["author"]["accountId"]));
+                std::string_view created = json_comment["created"].get_string();
+                comment.published_date = Utils::parseTimestapm(created.data(), created.size());
+                CommentText comment_text(comment, options);
+                Element body = json_comment["body"];
+                std::string_view plain;
+                if (body.get(plain) == simdjson::SUCCESS) {
+                    comment_text.append(plain.data(), plain.size());
+                } else {
+                    comment_text.appendDocument(body);
+                }
+                comment_text.breakLine();
+            }
+        }
+        if (present(fields, "subtasks", found)) {
+            simdjson::dom::array subtasks = found.get_array();
+            issue->subtasks_ids.reserve(subtasks.size());
+            for (Element json_subtask : subtasks) {
+                issue->subtasks_ids.push_back(text(json_subtask["id"]));
+            }
+        }
+        JIRA_LOG_DEBUG(types_logger, "Parsed json -> issue\n--id: {}\n--key: {}\n--title: {}\n--type: {}\n--assignee: {}",
+            issue->id, issue->key, issue->title, issue->type, AccountIndex::accountId(issue->assignee));
+        return issue;
+    }
+
+    // Parsers keep their buffers between pages. A parser is not shared: while a page is
+    // mapped, the thread may run another task which parses its own page.
+    class ParserPool {
+        public:
+            std::unique_ptr<simdjson::dom::parser> take() {
+                std::lock_guard<std::mutex> guard(mutex);
+                if (parsers.empty()) {
+                    return std::unique_ptr<simdjson::dom::parser>(new simdjson::dom::parser());
+                }
+                std::unique_ptr<simdjson::dom::parser> parser = std::move(parsers.back());
+                parsers.pop_back();
+                return parser;
+            }
+
+            void give(std::unique_ptr<simdjson::dom::parser> parser) {
+                std::lock_guard<std::mutex> guard(mutex);
+                parsers.push_back(std::move(parser));
+            }
+
+        private:
+            std::mutex mutex;
+            std::vector<std::unique_ptr<simdjson::dom::parser>> parsers;
+    };
+
+    ParserPool& parsers() {
+        static ParserPool pool;
+        return pool;
+    }
+
+    PageEnvelope pageFromSimdjson(const std::string& page, const std::string& items_key, std::vector<JiraIssue*>& issues,
+        JiraArena* arena, const ParseOptions& options, Executor* executor) {
+        std::unique_ptr<simdjson::dom::parser> parser = parsers().take();
+        PageEnvelope envelope;
+        try {
+            Element root = parser->parse(page);
+            Element value;
+            if (root["startAt"].get(value) == simdjson::SUCCESS) {
+                envelope.start_at = number(value);
+            }
+            if (root["isLast"].get(value) == simdjson::SUCCESS) {
+                envelope.is_last = value.get_bool().value() ? 1 : 0;
+            }
+            if (root["total"].get(value) == simdjson::SUCCESS) {
+                envelope.total = number(value);
+            }
+            if (root["maxResults"].get(value) == simdjson::SUCCESS) {
+                envelope.max_results = number(value);
+            }
+            simdjson::dom::array items;
+            if (root[items_key].get(items) == simdjson::SUCCESS) {
+                // the array is walked once, then elements are mapped in any order
+                std::vector<Element> elements;
+                elements.reserve(items.size());
+                for (Element item : items) {
+                    elements.push_back(item);
+                }
+                envelope.received = static_cast<int>(elements.size());
+                mapIssues(issues, elements.size(), options.issues_per_task, executor, [&](size_t i) {
+                    return issueFromElement(elements[i], arena, options);
+                });
+            }
+        } catch (...) {
+            parsers().give(std::move(parser));
+            throw;
+        }
+        parsers().give(std::move(parser));
+        return envelope;
+    }
+#endif
+}
+
+AccountHandle AccountIndex::intern(const std::string& account_id) {
+    if (account_id.empty()) {
+        return NO_ACCOUNT;
+    }
+    AccountTable& table = accounts();
+    std::lock_guard<std::mutex> guard(table.mutex);
+    auto found = table.handles.find(account_id);
+    if (found != table.handles.end()) {
+        return found->second;
+    }
+    table.ids.push_back(account_id);
+    AccountHandle handle = static_cast<AccountHandle>(table.ids.size());
+    table.handles.insert({account_id, handle});
+    return handle;
+}
+
+const std::string& AccountIndex::accountId(AccountHandle handle) {
+    static const std::string empty;
+    AccountTable& table = accounts();
+    std::lock_guard<std::mutex> guard(table.mutex);
+    if (handle == NO_ACCOUNT || handle > table.ids.size()) {
+        return empty;
+    }
+    return table.ids[handle - 1];
+}
+
+size_t AccountIndex::size() {
+    AccountTable& table = accounts();
+    std::lock_guard<std::mutex> guard(table.mutex);
+    return table.ids.size();
+}
+
+JiraUser::~JiraUser() {}
+
+JiraIssue::~JiraIssue() {}
+
+JiraSprint::~JiraSprint() {}
+
+PersonalResult::~PersonalResult() {}
 
 JiraUser* JiraUser::fromJSON(std::string json_string) {
-    types_logger->trace("JiraUser::fromJSON() called for {}", json_string);
-    JiraUser *user = new JiraUser();
-    json json_data = json::parse(json_string);
+    JIRA_LOG_TRACE(types_logger, "JiraUser::fromJSON() called for {}", json_string);
+    return JiraUser::fromJSON(json::parse(json_string));
+}
+
+JiraUser* JiraUser::fromJSON(const json& json_data, JiraArena* arena) {
+    JiraUser *user = arena != nullptr ? arena->users.create() : new JiraUser();
     json_data.at("accountId").get_to(user->id);
+    user->handle = AccountIndex::intern(user->id);
     json_data.at("displayName").get_to(user->name);
-    types_logger->debug("Parsed json -> user\n--id: {}\n--name: {}", user->id, user->name);
+    JIRA_LOG_DEBUG(types_logger, "Parsed json -> user\n--id: {}\n--name: {}", user->id, user->name);
     return user;
 }
 
 JiraSprint* JiraSprint::fromJSON(std::string json_string) {
-    types_logger->trace("JiraSprint::fromJSON() called for {}", json_string);
-    JiraSprint *sprint = new JiraSprint();
-    json json_data = json::parse(json_string);
+    JIRA_LOG_TRACE(types_logger, "JiraSprint::fromJSON() called for {}", json_string);
+    return JiraSprint::fromJSON(json::parse(json_string));
+}
+
+JiraSprint* JiraSprint::fromJSON(const json& json_data, JiraArena* arena) {
+    JiraSprint *sprint = arena != nullptr ? arena->sprints.create() : new JiraSprint();
     json_data.at("id").get_to(sprint->id);
     json_data.at("name").get_to(sprint->name);
     json_data.at("originBoardId").get_to(sprint->board_id);
-    sprint->is_closed = !(json_data.at("state").get<std::string>().compare("closed"));
-    if (json_data.contains("startDate")) {
-        sprint->start_date = Utils::parseTimestapm(json_data.at("startDate").get<std::string>());
+    sprint->is_closed = json_data.at("state").get_ref<const std::string&>() == "closed";
+    auto found = json_data.find("startDate");
+    if (found != json_data.end()) {
+        sprint->start_date = Utils::parseTimestapm(found->get_ref<const std::string&>());
     }
-    if (json_data.contains("endDate")) {
-        sprint->end_date = Utils::parseTimestapm(json_data.at("endDate").get<std::string>());
+    found = json_data.find("endDate");
+    if (found != json_data.end()) {
+        sprint->end_date = Utils::parseTimestapm(found->get_ref<const std::string&>());
     }
-    if (json_data.contains("completeDate")) {
-        sprint->complete_date = Utils::parseTimestapm(json_data.at("completeDate").get<std::string>());
+    found = json_data.find("completeDate");
+    if (found != json_data.end()) {
+        sprint->complete_date = Utils::parseTimestapm(found->get_ref<const std::string&>());
     }
     // TODO: when class will be improved with uniq_ptr, complete_date print shall be wrapped with IF
-    types_logger->debug("Parsed json -> sprint\n--name: {}\n--start date: {}\n--end date: {}\n--complete date: {}",
+    JIRA_LOG_DEBUG(types_logger, "Parsed json -> sprint\n--name: {}\n--start date: {}\n--end date: {}\n--complete date: {}",
         sprint->name, Utils::timeToString(sprint->start_date), Utils::timeToString(sprint->end_date), Utils::timeToString(sprint->complete_date));
     return sprint;
 }
 
 JiraIssue* JiraIssue::fromJSON(std::string json_string) {
-    types_logger->trace("JiraIssue::fromJSON() called for {}", json_string);
-    JiraIssue *issue = new JiraIssue();
-    json json_data = json::parse(json_string);
+    JIRA_LOG_TRACE(types_logger, "JiraIssue::fromJSON() called for {}", json_string);
+    return JiraIssue::fromJSON(json::parse(json_string));
+}
+
+JiraIssue* JiraIssue::fromJSON(const json& json_data, JiraArena* arena, const ParseOptions& options) {
+    JiraIssue *issue = arena != nullptr ? arena->issues.create() : new JiraIssue();
     json_data.at("id").get_to(issue->id);
     json_data.at("key").get_to(issue->key);
-    if (!json_data.at("fields").at("customfield_10125").is_null()) {
-        json_data.at("fields").at("customfield_10125").get_to(issue->story_points);
+    const json& fields = json_data.at("fields");
+    auto found = fields.find(STORY_POINTS_FIELD);
+    if (found != fields.end() && !found->is_null()) {
+        found->get_to(issue->story_points);
     }
-    if (json_data.at("fields").at("issuetype").at("subtask").get<bool>()) {
+    const json& issue_type = fields.at("issuetype");
+    if (issue_type.at("subtask").get<bool>()) {
         issue->type = IssueType::Subtask;
     } else {
-        issue->type = static_cast<IssueType>(stoi(json_data.at("fields").at("issuetype").at("id").get<std::string>()));
+        issue->type = static_cast<IssueType>(stoi(issue_type.at("id").get_ref<const std::string&>()));
     }
-    if (json_data.at("fields").contains("assignee")) {
-        json_data.at("fields").at("assignee").at("accountId").get_to(issue->assignee_id);
+    found = fields.find("assignee");
+    if (found != fields.end() && !found->is_null()) {
+        issue->assignee = AccountIndex::intern(found->at("accountId").get_ref<const std::string&>());
     }
-    json_data.at("fields").at("summary").get_to(issue->title);
+    fields.at("summary").get_to(issue->title);
+    const json& status = fields.at("status");
     issue->status = IssueStatus{
-        .id = json_data.at("fields").at("status").at("id").get<std::string>(), 
-        .name = json_data.at("fields").at("status").at("name").get<std::string>()};
-    if (!json_data.at("fields").at("resolution").is_null()) {
+        .id = status.at("id").get<std::string>(), 
+        .name = status.at("name").get<std::string>()};
+    // a missing resolution (e.g. not in the requested fields) means not resolved, like null
+    found = fields.find("resolution");
+    if (found != fields.end() && !found->is_null()) {
         issue->resolved = true;
-        issue->resolution_date = Utils::parseTimestapm(json_data.at("fields").at("resolutiondate").get<std::string>());
+        issue->resolution_date = Utils::parseTimestapm(fields.at("resolutiondate").get_ref<const std::string&>());
     }
-    if (json_data.at("fields").contains("parent")) {
-        json_data.at("fields").at("parent").at("id").get_to(issue->parent_id);
+    found = fields.find("parent");
+    if (found != fields.end()) {
+        found->at("id").get_to(issue->parent_id);
     }
-    if (json_data.at("fields").contains("comment") && !json_data.at("fields").at("comment").at("comments").is_null()) {
-        for(auto json_comment : json_data.at("fields").at("comment").at("comments")) {
-            std::string message = json_comment.at("body").get<std::string>();
-            message.erase(std::remove(message.begin(), message.end(), '\n'), message.end());    // remove newlines
-            Comment comment = {
-                .id = json_comment.at("id").get<std::string>(),
-                .authour_id = json_comment.at("author").at("accountId").get<std::string>(),
-                .text = message,
-                .published_date = Utils::parseTimestapm(json_comment.at("created").get<std::string>())};
-            issue->comments.push_back(comment);
+    found = fields.find("comment");
+    if (found != fields.end() && !found->at("comments").is_null()) {
+        const json& comments = found->at("comments");
+        issue->comments.reserve(comments.size());
+        for(const auto& json_comment : comments) {
+            issue->comments.emplace_back();
+            Comment& comment = issue->comments.back();
+            json_comment.at("id").get_to(comment.id);
+            comment.author = AccountIndex::intern(json_comment.at("author").at("accountId").get_ref<const std::string&>());
+            comment.published_date = Utils::parseTimestapm(json_comment.at("created").get_ref<const std::string&>());
+            CommentText text(comment, options);
+            const json& body = json_comment.at("body");
+            if (body.is_string()) {
+                text.append(body.get_ref<const std::string&>());
+            } else {
+                text.appendDocument(body);
+            }
+            text.breakLine();
         }
     }
-    if (json_data.at("fields").contains("subtasks") && !json_data.at("fields").at("subtasks").is_null()) {
-        for(auto json_subtask : json_data.at("fields").at("subtasks")) {
+    found = fields.find("subtasks");
+    if (found != fields.end() && !found->is_null()) {
+        issue->subtasks_ids.reserve(found->size());
+        for(const auto& json_subtask : *found) {
             issue->subtasks_ids.push_back(json_subtask.at("id").get<std::string>());
         }
     }
-    types_logger->debug("Parsed json -> issue\n--id: {}\n--key: {}\n--title: {}\n--type: {}\n--assignee: {}",
-        issue->id, issue->key, issue->title, issue->type, issue->assignee_id);
+    JIRA_LOG_DEBUG(types_logger, "Parsed json -> issue\n--id: {}\n--key: {}\n--title: {}\n--type: {}\n--assignee: {}",
+        issue->id, issue->key, issue->title, issue->type, AccountIndex::accountId(issue->assignee));
     return issue;
-}
\ No newline at end of file
+}
+
+std::vector<JiraIssue*> JiraIssue::fromJSONArray(const json& json_issues, JiraArena* arena, const ParseOptions& options, Executor* executor) {
+    std::vector<JiraIssue*> issues;
+    mapIssues(issues, json_issues.size(), options.issues_per_task, executor, [&](size_t i) {
+        return JiraIssue::fromJSON(json_issues[i], arena, options);
+    });
+    return issues;
+}
+
+PageEnvelope JiraIssue::fromPage(const std::string& page, const std::string& items_key, std::vector<JiraIssue*>& issues,
+    JiraArena* arena, const ParseOptions& options, Executor* executor) {
+#ifdef JIRA_USE_SIMDJSON
+    if (options.parser == JsonParser::Simdjson) {
+        return pageFromSimdjson(page, items_key, issues, arena, options, executor);
+    }
+#endif
+    json parsed = json::parse(page);
+    PageEnvelope envelope = PageIterator::envelope(parsed, items_key);
+    auto items = parsed.find(items_key);
+    if (items != parsed.end() && items->is_array()) {
+        std::vector<JiraIssue*> mapped = JiraIssue::fromJSONArray(*items, arena, options, executor);
+        issues.insert(issues.end(), mapped.begin(), mapped.end());
+    }
+    return envelope;
+}
+
+bool JiraIssue::simdjsonAvailable() {
+#ifdef JIRA_USE_SIMDJSON
+    return true;
+#else
+    return false;
+#endif
+}
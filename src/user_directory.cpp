@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+#include "jira/user_directory.hpp"
+
+using json = nlohmann::json;
+
+void UserDirectory::setTtl(double seconds) {
+    std::lock_guard<std::mutex> guard(mutex);
+    ttl = seconds;
+}
+
+bool UserDirectory::find(const std::string& name, Entry& entry) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto found = entries.find(name);
+    if (found == entries.end()) {
+        return false;
+    }
+    entry = found->second;
+    return true;
+}
+
+bool UserDirectory::isFresh(const Entry& entry, time_t now) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return difftime(now, entry.resolved_at) < ttl;
+}
+
+void UserDirectory::add(const std::string& name, const JiraUser& user, time_t resolved_at) {
+    std::lock_guard<std::mutex> guard(mutex);
+    Entry& entry = entries[name];
+    entry.account_id = user.id;
+    entry.display_name = user.name;
+    entry.resolved_at = resolved_at;
+}
+
+void UserDirectory::remove(const std::string& name) {
+    std::lock_guard<std::mutex> guard(mutex);
+    entries.erase(name);
+}
+
+size_t UserDirectory::size() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return entries.size();
+}
+
+bool UserDirectory::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    json data = json::parse(file, nullptr, false);
+    if (data.is_discarded() || !data.is_object()) {
+        return false;
+    }
+    auto users = data.find("users");
+    if (users == data.end()) {
+        return true;
+    }
+    if (!users->is_object()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    for (const auto& user : users->items()) {
+        const json& value = user.value();
+        // a damaged entry is skipped, its name will be searched again
+        if (!value.is_object() || !value.contains("account_id") || !value["account_id"].is_string()
+            || !value.contains("display_name") || !value["display_name"].is_string()
+            || !value.contains("resolved_at") || !value["resolved_at"].is_number_integer()) {
+            continue;
+        }
+        Entry& entry = entries[user.key()];
+        entry.account_id = value["account_id"].get<std::string>();
+        entry.display_name = value["display_name"].get<std::string>();
+        entry.resolved_at = value["resolved_at"].get<time_t>();
+    }
+    return true;
+}
+
+void UserDirectory::save(const std::string& path) const {
+    // the lock is kept while writing, so concurrent saves don't share the temporary file
+    std::lock_guard<std::mutex> guard(mutex);
+    json data = {{"users", json::object()}};
+    for (const auto& entry : entries) {
+        data["users"][entry.first] = {
+            {"account_id", entry.second.account_id},
+            {"display_name", entry.second.display_name},
+            {"resolved_at", entry.second.resolved_at}};
+    }
+    std::string temporary = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream file(temporary);
+        file << data.dump();
+        if (!file.good()) {
+            throw std::runtime_error("Cannot write user directory: " + temporary);
+        }
+    }
+    std::rename(temporary.c_str(), path.c_str());
+}
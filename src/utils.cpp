@@ -1,19 +1,117 @@
 #include "utils.hpp"
 
-#include <sstream>
-#include <iomanip>
-#include <chrono>
+#include <cstdint>
 
-time_t Utils::parseTimestapm(std::string timestamp) {
+namespace {
+
+    // Reads exactly `count` digits, moves `position` behind them
+    bool readNumber(const char*& position, const char* end, int count, int& value) {
+        if (end - position < count) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < count; i++) {
+            char c = position[i];
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            value = value * 10 + (c - '0');
+        }
+        position += count;
+        return true;
+    }
+
+    // Number of days since 1970-01-01 for a date of proleptic Gregorian calendar
+    int64_t daysFromCivil(int year, int month, int day) {
+        year -= month <= 2;
+        const int64_t era = (year >= 0 ? year : year - 399) / 400;
+        const int64_t year_of_era = year - era * 400;
+        const int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+        return era * 146097 + day_of_era - 719468;
+    }
+}
+
+time_t Utils::parseTimestapm(const std::string& timestamp) {
+    return parseTimestapm(timestamp.data(), timestamp.length());
+}
+
+time_t Utils::parseTimestapm(const char* timestamp, size_t length) {
+    const char* position = timestamp;
+    const char* end = timestamp + length;
+    int year, month, day;
+    int hour = 0, minute = 0, second = 0;
+    if (!readNumber(position, end, 4, year) || position == end || *position++ != '-' ||
+        !readNumber(position, end, 2, month) || position == end || *position++ != '-' ||
+        !readNumber(position, end, 2, day)) {
+        return (time_t)(-1);
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        return (time_t)(-1);
+    }
+    // time part is optional, everything after the date that is not a time is ignored
+    if (position != end && (*position == 'T' || *position == ' ')) {
+        position++;
+        if (!readNumber(position, end, 2, hour) || position == end || *position++ != ':' ||
+            !readNumber(position, end, 2, minute)) {
+            return (time_t)(-1);
+        }
+        if (position != end && *position == ':') {
+            position++;
+            if (!readNumber(position, end, 2, second)) {
+                return (time_t)(-1);
+            }
+        }
+        // fractional seconds are accepted but time_t keeps only whole seconds
+        if (position != end && (*position == '.' || *position == ',')) {
+            position++;
+            while (position != end && *position >= '0' && *position <= '9') {
+                position++;
+            }
+        }
+    }
+    if (position != end && (*position == 'Z' || *position == 'z')) {
+        return static_cast<time_t>(daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second);
+    }
+    if (position != end && (*position == '+' || *position == '-')) {
+        int sign = *position++ == '-' ? -1 : 1;
+        int offset_hours, offset_minutes = 0;
+        if (!readNumber(position, end, 2, offset_hours)) {
+            return (time_t)(-1);
+        }
+        if (position != end && *position == ':') {
+            position++;
+        }
+        if (position != end) {
+            readNumber(position, end, 2, offset_minutes);
+        }
+        int64_t utc = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+        return static_cast<time_t>(utc - sign * (offset_hours * 3600 + offset_minutes * 60));
+    }
+    // without an offset the time is local, like dates from params.json
     std::tm date = {};
-    std::stringstream ss {timestamp};
-    ss >> std::get_time(&date, "%Y-%m-%dT%H:%M:%S");
+    date.tm_year = year - 1900;
+    date.tm_mon = month - 1;
+    date.tm_mday = day;
+    date.tm_hour = hour;
+    date.tm_min = minute;
+    date.tm_sec = second;
+    date.tm_isdst = -1;
     return mktime(&date);
 }
 
+size_t Utils::timeToString(const time_t time, char* buffer, size_t size) {
+    std::tm date = {};
+#if defined(_WIN32)
+    localtime_s(&date, &time);
+#else
+    localtime_r(&time, &date);
+#endif
+    return strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &date);
+}
+
 std::string Utils::timeToString(const time_t time) {
     char buffer[26];
-    std::tm* date = localtime(&time);
-    strftime(buffer, 26, "%Y-%m-%d %H:%M:%S", date);
-    return std::string(buffer);
-};
\ No newline at end of file
+    size_t length = timeToString(time, buffer, sizeof(buffer));
+    return std::string(buffer, length);
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+#include "jira/board_index.hpp"
+
+namespace {
+    JiraSprint makeSprint(int id, const std::string& name, time_t start, time_t complete) {
+        JiraSprint sprint;
+        sprint.id = id;
+        sprint.board_id = 1;
+        sprint.name = name;
+        sprint.start_date = start;
+        sprint.end_date = complete;
+        sprint.complete_date = complete;
+        sprint.is_closed = complete > 0;
+        return sprint;
+    }
+}
+
+TEST(BoardIndex, SprintsByNames) {
+    BoardIndex index;
+    index.setSprints(1, {makeSprint(2, "S2", 200, 290), makeSprint(1, "S1", 100, 190)});
+    EXPECT_EQ(index.boardId("Team"), -1);
+    auto sprints = index.sprintsByNames(1, {"S2", "S1", "missing"});
+    ASSERT_EQ(sprints.size(), 2u);
+    EXPECT_EQ(sprints[0].id, 1);
+    EXPECT_EQ(sprints[1].id, 2);
+    EXPECT_TRUE(index.sprintsByNames(2, {"S1"}).empty());
+}
+
+TEST(BoardIndex, SprintsBetween) {
+    BoardIndex index;
+    index.setSprints(1, {makeSprint(3, "S3", 300, 0), makeSprint(1, "S1", 100, 190), makeSprint(2, "S2", 200, 290)});
+    auto sprints = index.sprintsBetween(1, 150, 400);
+    ASSERT_EQ(sprints.size(), 2u);
+    EXPECT_EQ(sprints[0].id, 2);
+    EXPECT_EQ(sprints[1].id, 3);
+    EXPECT_TRUE(index.sprintsBetween(1, 50, 100).empty());
+}
+
+TEST(BoardIndex, SaveAndLoad) {
+    BoardIndex index;
+    index.setBoards({{"Team", 1}});
+    index.setSprints(1, {makeSprint(1, "S1", 100, 190), makeSprint(2, "S2", 200, 290)});
+    std::string path = testing::TempDir() + "board-index-unit.json";
+    index.save(path);
+
+    BoardIndex loaded;
+    ASSERT_TRUE(loaded.load(path));
+    std::remove(path.c_str());
+    EXPECT_EQ(loaded.boardId("Team"), 1);
+    EXPECT_FALSE(loaded.isFresh(1));
+    auto sprints = loaded.sprints(1);
+    ASSERT_EQ(sprints.size(), 2u);
+    EXPECT_EQ(sprints[1].name, "S2");
+    EXPECT_EQ(sprints[1].complete_date, 290);
+    EXPECT_TRUE(sprints[1].is_closed);
+}
+
+TEST(BoardIndex, SkipsDamagedEntries) {
+    std::string path = testing::TempDir() + "board-index-damaged.json";
+    std::ofstream(path) << R"({"boards": {"Team": 1, "Other": "2"}, "sprints": {)"
+        R"("1": [{"id": 1, "board_id": 1, "name": "S1", "start_date": 100, "end_date": 190, "complete_date": 190, "closed": true}],)"
+        R"("2": [{"id": 3, "board_id": 2, "name": "S3", "start_date": 100}],)"
+        R"("three": [], "4": {"id": 4}}})";
+    BoardIndex index;
+    EXPECT_TRUE(index.load(path));
+    EXPECT_EQ(index.boardId("Team"), 1);
+    EXPECT_EQ(index.boardId("Other"), -1);
+    EXPECT_EQ(index.sprints(1).size(), 1u);
+    EXPECT_TRUE(index.sprints(2).empty());
+    EXPECT_TRUE(index.sprints(4).empty());
+
+    std::ofstream(path, std::ios::trunc) << R"({"boards": [1, 2]})";
+    EXPECT_FALSE(index.load(path));
+    std::remove(path.c_str());
+}
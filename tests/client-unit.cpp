@@ -0,0 +1,348 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "jira/jira_client.hpp"
+#include "jira/transport.hpp"
+#include "mock_jira_server.hpp"
+
+namespace {
+    const std::string ALICE = "account-alice";
+    const std::string BOB = "account-bob";
+
+    // two closed sprints and an active one on "Team board"; sprint 1 has 5 issues, pages are 2 issues long
+    void fillBoard(MockJiraServer& server) {
+        server.addUser(ALICE, "Alice Smith");
+        server.addUser(BOB, "Bob Brown");
+        server.addBoard(7, "Team board");
+        server.addSprint(7, 1, "Sprint 1", "closed", "2020-06-01T09:00:00.000Z", "2020-06-14T18:00:00.000Z", "2020-06-14T18:00:00.000Z");
+        server.addSprint(7, 2, "Sprint 2", "closed", "2020-06-15T09:00:00.000Z", "2020-06-28T18:00:00.000Z", "2020-06-28T18:00:00.000Z");
+        server.addSprint(7, 3, "Sprint 3", "active", "2020-06-29T09:00:00.000Z", "2020-07-12T18:00:00.000Z");
+        server.addIssue(1, MockJiraServer::issue(11, IssueType::Story, ALICE, "2020-06-05T12:00:00.000Z",
+            {{BOB, "2020-06-04T12:00:00.000Z"}}));
+        server.addIssue(1, MockJiraServer::issue(12, IssueType::Bug, ALICE, "2020-06-20T12:00:00.000Z"));
+        server.addIssue(1, MockJiraServer::issue(13, IssueType::Task, BOB, "2020-06-10T12:00:00.000Z",
+            {{ALICE, "2020-06-09T12:00:00.000Z"}, {ALICE, "2020-06-10T12:00:00.000Z"}}));
+        server.addIssue(1, MockJiraServer::issue(14, IssueType::Story, BOB, ""));
+        server.addIssue(1, MockJiraServer::issue(15, IssueType::Task, "", ""));
+        server.addIssue(2, MockJiraServer::issue(21, IssueType::Story, ALICE, "2020-06-16T12:00:00.000Z"));
+        server.addIssue(3, MockJiraServer::issue(31, IssueType::Story, BOB, ""));
+    }
+
+    std::unique_ptr<JiraClient> connect(const MockJiraServer& server, std::shared_ptr<Transport> transport = nullptr) {
+        if (!transport) {
+            transport = std::make_shared<CprTransport>("tester", "token");
+        }
+        std::unique_ptr<JiraClient> client(new JiraClient(server.url(), transport));
+        SchedulerOptions options;
+        options.requests_per_second = 1000;
+        options.burst = 1000;
+        options.base_backoff = 0.01;
+        client->setRateLimit(options);
+        return client;
+    }
+
+    std::string temporaryDirectory() {
+        std::string pattern = testing::TempDir() + "jira-client-XXXXXX";
+        std::vector<char> path(pattern.begin(), pattern.end());
+        path.push_back('\0');
+        return mkdtemp(path.data());
+    }
+
+    void removeDirectory(const std::string& directory) {
+        std::system(("rm -rf '" + directory + "'").c_str());
+    }
+}
+
+TEST(MockJira, GetPerson) {
+    MockJiraServer server;
+    fillBoard(server);
+    server.addUser("account-alice-2", "Alice Jones");
+    auto client = connect(server);
+    EXPECT_THROW(client->getPerson("alice"), std::invalid_argument);
+    EXPECT_THROW(client->getPerson("nobody"), std::invalid_argument);
+    JiraUser* alice = client->getPerson("alice smith");
+    EXPECT_EQ(alice->id, ALICE);
+    EXPECT_EQ(alice->name, "Alice Smith");
+    // found users are remembered
+    EXPECT_EQ(client->getPerson("alice smith"), alice);
+    EXPECT_EQ(server.requests("/user/search"), 3u);
+}
+
+TEST(MockJira, GetPersonsFromDirectory) {
+    MockJiraServer server;
+    fillBoard(server);
+    server.addUser("account-carol", "Carol White");
+    std::vector<std::string> names = {"alice smith", "bob", "carol"};
+    std::string directory = temporaryDirectory();
+    {
+        auto client = connect(server);
+        client->setCacheDirectory(directory);
+        std::vector<JiraUser*> people = client->getPersons(names);
+        ASSERT_EQ(people.size(), 3u);
+        EXPECT_EQ(people[0]->id, ALICE);
+        EXPECT_EQ(people[1]->id, BOB);
+        EXPECT_EQ(people[2]->name, "Carol White");
+        EXPECT_THROW(client->getPersons({"bob", "nobody"}), std::invalid_argument);
+    }
+    EXPECT_EQ(server.requests("/user/search"), 4u);
+    // a warm run needs no requests
+    {
+        auto client = connect(server);
+        client->setCacheDirectory(directory);
+        std::vector<JiraUser*> people = client->getPersons(names);
+        ASSERT_EQ(people.size(), 3u);
+        EXPECT_EQ(people[1]->id, BOB);
+        EXPECT_EQ(people[1]->handle, AccountIndex::intern(BOB));
+    }
+    EXPECT_EQ(server.requests("/user/search"), 4u);
+    EXPECT_EQ(server.requests("/user"), 0u);
+    // stale names are checked by account ids
+    auto client = connect(server);
+    client->setCacheDirectory(directory);
+    client->setUserTtl(0);
+    EXPECT_EQ(client->getPersons(names)[2]->name, "Carol White");
+    EXPECT_EQ(server.requests("/user/search"), 4u);
+    EXPECT_EQ(server.requests("/user"), 3u);
+    removeDirectory(directory);
+}
+
+TEST(MockJira, SprintsByNamesAcrossPages) {
+    MockJiraServer server;
+    fillBoard(server);
+    auto client = connect(server);
+    auto sprints = client->getSprints("Team board", {"Sprint 2", "Sprint 1"});
+    ASSERT_EQ(sprints.size(), 2u);
+    EXPECT_EQ(sprints[0]->name, "Sprint 1");
+    EXPECT_EQ(sprints[0]->issues.size(), 5u);
+    EXPECT_EQ(sprints[1]->issues.size(), 1u);
+    // 5 issues in pages of 2
+    EXPECT_EQ(server.requests("/board/{id}/sprint/{id}/issue"), 4u);
+    EXPECT_THROW(client->getSprints("Unknown board", {"Sprint 1"}), std::logic_error);
+}
+
+TEST(MockJira, SprintResults) {
+    MockJiraServer server;
+    fillBoard(server);
+    auto client = connect(server);
+    std::vector<JiraUser*> people = {client->getPerson("Alice"), client->getPerson("Bob")};
+    auto sprints = client->getSprints("Team board", "2020-05-31T00:00:00", "2020-06-15T00:00:00");
+    ASSERT_EQ(sprints.size(), 1u);
+    auto results = client->getSprintResults(people, *sprints[0]);
+    ASSERT_EQ(results.size(), 2u);
+    // issue 12 was resolved after the end of the sprint
+    EXPECT_EQ(results[0]->finished.size(), 1u);
+    EXPECT_EQ(results[0]->not_finished.size(), 1u);
+    EXPECT_EQ(results[0]->comments_written.size(), 2u);
+    EXPECT_EQ(results[0]->issues_reviwed, 1);
+    EXPECT_EQ(results[1]->finished.size(), 1u);
+    EXPECT_EQ(results[1]->not_finished.size(), 1u);
+    EXPECT_EQ(results[1]->issues_reviwed, 1);
+}
+
+TEST(MockJira, SprintResultsOfRepeatedPerson) {
+    MockJiraServer server;
+    fillBoard(server);
+    auto client = connect(server);
+    JiraUser* alice = client->getPerson("Alice");
+    auto sprints = client->getSprints("Team board", {"Sprint 1"});
+    auto results = client->getSprintResults({alice, client->getPerson("Bob"), alice}, *sprints[0]);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_NE(results[0], results[2]);
+    for (auto result : {results[0], results[2]}) {
+        EXPECT_EQ(result->user_id, ALICE);
+        EXPECT_EQ(result->finished.size(), 1u);
+        EXPECT_EQ(result->not_finished.size(), 1u);
+        EXPECT_EQ(result->comments_written.size(), 2u);
+        EXPECT_EQ(result->issues_reviwed, 1);
+    }
+    EXPECT_EQ(results[1]->user_id, BOB);
+    EXPECT_EQ(results[1]->finished.size(), 1u);
+}
+
+TEST(MockJira, AsyncRequests) {
+    MockOptions options;
+    options.latency_ms = 20;
+    MockJiraServer server(options);
+    fillBoard(server);
+    auto client = connect(server);
+    auto person = client->getPersonAsync("Bob");
+    auto sprints = client->getSprintsAsync("Team board", {"Sprint 1", "Sprint 3"});
+    EXPECT_EQ(person.get()->id, BOB);
+    auto loaded = sprints.get();
+    ASSERT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded[0]->issues.size(), 5u);
+    EXPECT_EQ(loaded[1]->issues.size(), 1u);
+}
+
+TEST(MockJira, SeveralBoardsAtOnce) {
+    MockOptions options;
+    options.latency_ms = 5;
+    MockJiraServer server(options);
+    fillBoard(server);
+    server.addBoard(8, "Other board");
+    for (int sprint = 4; sprint <= 6; sprint++) {
+        server.addSprint(8, sprint, "Other " + std::to_string(sprint), "closed", "2020-06-01T09:00:00.000Z", "2020-06-14T18:00:00.000Z", "2020-06-14T18:00:00.000Z");
+        for (int i = 0; i < sprint; i++) {
+            server.addIssue(sprint, MockJiraServer::issue(sprint * 10 + i, IssueType::Task, BOB, "2020-06-05T12:00:00.000Z"));
+        }
+    }
+    auto client = connect(server);
+    client->setExecutor(std::make_shared<Executor>(2));
+    auto team = client->getSprintsAsync("Team board", {"Sprint 1", "Sprint 2", "Sprint 3"});
+    auto other = client->getSprintsAsync("Other board", "2020-05-01T00:00:00", "2020-07-01T00:00:00");
+    auto bob = client->getPersonAsync("Bob");
+    EXPECT_EQ(client->getPerson("Bob"), bob.get());
+    EXPECT_EQ(server.requests("/user/search"), 1u);
+    auto team_sprints = team.get();
+    auto other_sprints = other.get();
+    ASSERT_EQ(team_sprints.size(), 3u);
+    ASSERT_EQ(other_sprints.size(), 3u);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(other_sprints[i]->board_id, 8);
+        EXPECT_EQ(other_sprints[i]->issues.size(), static_cast<size_t>(i + 4));
+    }
+    // the list of boards is loaded once for both of them
+    EXPECT_EQ(server.requests("/agile/1.0/board"), 1u);
+}
+
+TEST(MockJira, RetriesThrottledRequests) {
+    MockOptions options;
+    options.throttle_every = 3;
+    MockJiraServer server(options);
+    fillBoard(server);
+    auto client = connect(server);
+    auto sprints = client->getSprints("Team board", {"Sprint 1", "Sprint 2"});
+    ASSERT_EQ(sprints.size(), 2u);
+    EXPECT_EQ(sprints[0]->issues.size(), 5u);
+    EXPECT_EQ(sprints[1]->issues.size(), 1u);
+    EXPECT_GT(server.throttled(), 0u);
+    EXPECT_EQ(client->requestStats().throttled, server.throttled());
+}
+
+TEST(MockJira, ClosedSprintsFromCache) {
+    MockJiraServer server;
+    fillBoard(server);
+    std::string directory = temporaryDirectory();
+    {
+        auto client = connect(server);
+        client->setCacheDirectory(directory);
+        ASSERT_EQ(client->getSprints("Team board", {"Sprint 1"})[0]->issues.size(), 5u);
+    }
+    size_t issue_requests = server.requests("/board/{id}/sprint/{id}/issue");
+    size_t board_requests = server.requests("/agile/1.0/board");
+    auto client = connect(server);
+    client->setCacheDirectory(directory);
+    auto sprints = client->getSprints("Team board", {"Sprint 1"});
+    ASSERT_EQ(sprints.size(), 1u);
+    EXPECT_EQ(sprints[0]->issues.size(), 5u);
+    EXPECT_EQ(server.requests("/board/{id}/sprint/{id}/issue"), issue_requests);
+    EXPECT_EQ(server.requests("/agile/1.0/board"), board_requests);
+    removeDirectory(directory);
+}
+
+TEST(MockJira, NewClosedSprintBetweenRuns) {
+    MockJiraServer server;
+    fillBoard(server);
+    std::string directory = temporaryDirectory();
+    {
+        auto client = connect(server);
+        client->setCacheDirectory(directory);
+        ASSERT_EQ(client->getSprints("Team board", "2020-05-01T00:00:00.000Z", "2020-07-31T00:00:00.000Z").size(), 3u);
+    }
+    // created and closed while nobody was looking
+    server.addSprint(7, 4, "Sprint 4", "closed", "2020-07-13T09:00:00.000Z", "2020-07-26T18:00:00.000Z", "2020-07-26T18:00:00.000Z");
+    auto client = connect(server);
+    client->setCacheDirectory(directory);
+    auto sprints = client->getSprints("Team board", "2020-05-01T00:00:00.000Z", "2020-07-31T00:00:00.000Z");
+    ASSERT_EQ(sprints.size(), 4u);
+    EXPECT_EQ(sprints[3]->name, "Sprint 4");
+    EXPECT_TRUE(sprints[3]->is_closed);
+    removeDirectory(directory);
+}
+
+TEST(MockJira, SyncChangedIssuesOfOpenSprints) {
+    MockJiraServer server;
+    fillBoard(server);
+    server.addSprint(7, 4, "Sprint 4", "future", "2020-07-13T09:00:00.000Z", "2020-07-26T18:00:00.000Z");
+    server.addIssue(3, MockJiraServer::issue(32, IssueType::Task, ALICE, ""));
+    server.addIssue(3, MockJiraServer::issue(33, IssueType::Bug, ALICE, ""));
+    server.addIssue(4, MockJiraServer::issue(41, IssueType::Task, BOB, ""));
+    std::string directory = temporaryDirectory();
+    {
+        auto client = connect(server);
+        client->setCacheDirectory(directory);
+        auto sprints = client->getSprints("Team board", {"Sprint 3", "Sprint 4"});
+        ASSERT_EQ(sprints.size(), 2u);
+        ASSERT_EQ(sprints[0]->issues.size(), 3u);
+        ASSERT_EQ(sprints[1]->issues.size(), 1u);
+    }
+    // resolved in place, moved to the next sprint and moved to the backlog
+    server.updateIssue(3, MockJiraServer::issue(31, IssueType::Story, BOB, "2020-07-01T12:00:00.000Z"));
+    server.updateIssue(4, MockJiraServer::issue(32, IssueType::Task, ALICE, ""));
+    server.updateIssue(0, MockJiraServer::issue(33, IssueType::Bug, ALICE, ""));
+    size_t issue_requests = server.requests("/board/{id}/sprint/{id}/issue");
+    auto client = connect(server);
+    client->setCacheDirectory(directory);
+    auto sprints = client->getSprints("Team board", {"Sprint 3", "Sprint 4"});
+    ASSERT_EQ(sprints.size(), 2u);
+    ASSERT_EQ(sprints[0]->issues.size(), 1u);
+    EXPECT_EQ(sprints[0]->issues[0]->id, "31");
+    EXPECT_TRUE(sprints[0]->issues[0]->resolved);
+    ASSERT_EQ(sprints[1]->issues.size(), 2u);
+    EXPECT_EQ(sprints[1]->issues[0]->id, "41");
+    EXPECT_EQ(sprints[1]->issues[1]->id, "32");
+    // only the 3 updated issues are synced, in 2 pages, and sprints are not downloaded again
+    EXPECT_EQ(server.requests("/board/{id}/issue"), 2u);
+    EXPECT_EQ(server.requests("/board/{id}/sprint/{id}/issue"), issue_requests);
+    removeDirectory(directory);
+}
+
+TEST(MockJira, SyncDropsReassignedIssues) {
+    MockJiraServer server;
+    fillBoard(server);
+    server.addIssue(3, MockJiraServer::issue(32, IssueType::Task, BOB, ""));
+    std::string directory = temporaryDirectory();
+    {
+        auto client = connect(server);
+        client->setCacheDirectory(directory);
+        client->setTrackedPeople({client->getPerson("Bob")});
+        ASSERT_EQ(client->getSprints("Team board", {"Sprint 3"})[0]->issues.size(), 2u);
+    }
+    // the issue is not Bob's anymore, so the people filter would never return it again
+    server.updateIssue(3, MockJiraServer::issue(31, IssueType::Story, ALICE, ""));
+    auto client = connect(server);
+    client->setCacheDirectory(directory);
+    client->setTrackedPeople({client->getPerson("Bob")});
+    auto sprints = client->getSprints("Team board", {"Sprint 3"});
+    ASSERT_EQ(sprints.size(), 1u);
+    ASSERT_EQ(sprints[0]->issues.size(), 1u);
+    EXPECT_EQ(sprints[0]->issues[0]->id, "32");
+    EXPECT_EQ(server.requests("/board/{id}/issue"), 1u);
+    removeDirectory(directory);
+}
+
+TEST(MockJira, RecordAndReplay) {
+    std::string directory = temporaryDirectory();
+    MockJiraServer server;
+    fillBoard(server);
+    std::string url = server.url();
+    {
+        auto recorder = std::make_shared<ReplayTransport>(directory, ReplayTransport::Mode::Record, std::make_shared<CprTransport>("tester", "token"));
+        auto client = connect(server, recorder);
+        client->getPerson("Alice");
+        ASSERT_EQ(client->getSprints("Team board", {"Sprint 1"})[0]->issues.size(), 5u);
+    }
+    server.stop();
+    auto player = std::make_shared<ReplayTransport>(directory, ReplayTransport::Mode::Replay);
+    JiraClient client(url, player);
+    EXPECT_EQ(client.getPerson("Alice")->id, ALICE);
+    auto sprints = client.getSprints("Team board", {"Sprint 1"});
+    ASSERT_EQ(sprints.size(), 1u);
+    EXPECT_EQ(sprints[0]->issues.size(), 5u);
+    // nothing was recorded for this request
+    EXPECT_THROW(client.getPerson("Bob"), std::logic_error);
+    removeDirectory(directory);
+}
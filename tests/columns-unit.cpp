@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "jira/arena.hpp"
+#include "jira/columns.hpp"
+
+namespace {
+    const time_t SPRINT_END = 2000;
+
+    struct Row {
+        IssueType type;
+        const char* assignee;
+        int story_points;
+        bool resolved;
+        time_t resolution_date;
+    };
+
+    // counting rules of the per-type switch which the kernel replaced
+    PersonTally countWithSwitch(const std::vector<JiraIssue*>& issues, AccountHandle person, time_t sprint_end) {
+        PersonTally tally;
+        for (auto issue : issues) {
+            if (issue->assignee != person || !issue->resolved || difftime(issue->resolution_date, sprint_end) >= 0) {
+                continue;
+            }
+            switch (issue->type) {
+            case IssueType::Subtask:
+                tally.subtasks++;
+                tally.story_points += issue->story_points;
+                break;
+            case IssueType::Task:
+            case IssueType::Enabler:
+            case IssueType::Debt:
+                tally.issues++;
+                tally.story_points += issue->story_points;
+                break;
+            case IssueType::Bug:
+                tally.bugs++;
+                tally.story_points += issue->story_points;
+                break;
+            case IssueType::Story:
+                tally.issues++;
+                break;
+            default:
+                tally.others++;
+                break;
+            }
+        }
+        return tally;
+    }
+}
+
+TEST(SprintColumns, CountsLikePerTypeSwitch) {
+    const std::vector<Row> rows = {
+        {Story, "columns-alice", 8, true, 1500},        // points of stories are not counted
+        {Story, "columns-alice", 0, true, 1600},        // story without points
+        {Subtask, "columns-alice", 2, true, 1700},
+        {Bug, "columns-alice", 3, true, 1800},
+        {Task, "columns-alice", 5, false, -1},          // not resolved
+        {Task, "columns-alice", 5, true, 2000},         // resolved at the end of the sprint
+        {Enabler, "columns-alice", 1, true, 2500},      // resolved after the sprint
+        {Debt, "columns-alice", 1, true, 100},
+        {Epic, "columns-alice", 13, true, 1900},        // counted as other, points ignored
+        {Subtask, "columns-bob", 1, true, 1000},
+        {Bug, "columns-bob", 2, true, 1999},
+        {Bug, "columns-bob", 2, false, 1500},           // resolution date without resolution
+        {Task, "columns-carol", 3, true, 1200},         // not tracked
+        {Task, "", 3, true, 1200},                      // unassigned
+    };
+    JiraArena arena;
+    JiraSprint* sprint = arena.sprints.create();
+    sprint->end_date = SPRINT_END;
+    for (const auto& row : rows) {
+        JiraIssue* issue = arena.issues.create();
+        issue->type = row.type;
+        issue->assignee = AccountIndex::intern(row.assignee);
+        issue->story_points = row.story_points;
+        issue->resolved = row.resolved;
+        issue->resolution_date = row.resolution_date;
+        sprint->issues.push_back(issue);
+    }
+    std::vector<AccountHandle> people = {AccountIndex::intern("columns-alice"), AccountIndex::intern("columns-bob"), AccountIndex::intern("columns-dave")};
+    std::vector<PersonTally> tallies = SprintColumns::fromSprint(*sprint).countFinished(people, SPRINT_END);
+    ASSERT_EQ(tallies.size(), people.size());
+    for (size_t i = 0; i < people.size(); i++) {
+        PersonTally expected = countWithSwitch(sprint->issues, people[i], SPRINT_END);
+        EXPECT_EQ(tallies[i].subtasks, expected.subtasks) << "person " << i;
+        EXPECT_EQ(tallies[i].issues, expected.issues) << "person " << i;
+        EXPECT_EQ(tallies[i].bugs, expected.bugs) << "person " << i;
+        EXPECT_EQ(tallies[i].others, expected.others) << "person " << i;
+        EXPECT_EQ(tallies[i].story_points, expected.story_points) << "person " << i;
+    }
+    // the table itself, so both implementations can't be wrong the same way
+    EXPECT_EQ(tallies[0].issues, 3);
+    EXPECT_EQ(tallies[0].subtasks, 1);
+    EXPECT_EQ(tallies[0].bugs, 1);
+    EXPECT_EQ(tallies[0].others, 1);
+    EXPECT_EQ(tallies[0].story_points, 6);
+    EXPECT_EQ(tallies[1].subtasks + tallies[1].bugs, 2);
+    EXPECT_EQ(tallies[1].story_points, 3);
+    EXPECT_EQ(tallies[2].issues + tallies[2].story_points, 0);
+}
+
+TEST(SprintColumns, RepeatedPersonGetsEqualTallies) {
+    JiraArena arena;
+    JiraSprint* sprint = arena.sprints.create();
+    sprint->end_date = SPRINT_END;
+    for (IssueType type : {Task, Bug, Subtask}) {
+        JiraIssue* issue = arena.issues.create();
+        issue->type = type;
+        issue->assignee = AccountIndex::intern("columns-erin");
+        issue->story_points = 2;
+        issue->resolved = true;
+        issue->resolution_date = 1000;
+        sprint->issues.push_back(issue);
+    }
+    AccountHandle erin = AccountIndex::intern("columns-erin");
+    std::vector<PersonTally> tallies = SprintColumns::fromSprint(*sprint).countFinished(
+        {erin, AccountIndex::intern("columns-frank"), erin}, SPRINT_END);
+    ASSERT_EQ(tallies.size(), 3u);
+    for (size_t i : {0u, 2u}) {
+        EXPECT_EQ(tallies[i].issues, 1) << "position " << i;
+        EXPECT_EQ(tallies[i].bugs, 1) << "position " << i;
+        EXPECT_EQ(tallies[i].subtasks, 1) << "position " << i;
+        EXPECT_EQ(tallies[i].story_points, 6) << "position " << i;
+    }
+    EXPECT_EQ(tallies[1].issues + tallies[1].story_points, 0);
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <memory>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "report/daemon.hpp"
+#include "jira/transport.hpp"
+#include "mock_jira_server.hpp"
+
+namespace {
+    const std::string ALICE = "account-alice";
+
+    void fillBoard(MockJiraServer& server) {
+        server.addUser(ALICE, "Alice Smith");
+        server.addBoard(7, "Team board");
+        server.addSprint(7, 1, "Sprint 1", "closed", "2020-06-01T09:00:00.000Z", "2020-06-14T18:00:00.000Z", "2020-06-14T18:00:00.000Z");
+        server.addSprint(7, 2, "Sprint 2", "active", "2020-06-15T09:00:00.000Z", "2020-06-28T18:00:00.000Z");
+        server.addIssue(1, MockJiraServer::issue(11, IssueType::Task, ALICE, "2020-06-05T12:00:00.000Z"));
+        server.addIssue(1, MockJiraServer::issue(12, IssueType::Task, ALICE, "2020-06-06T12:00:00.000Z"));
+        server.addIssue(2, MockJiraServer::issue(21, IssueType::Task, ALICE, "2020-06-16T12:00:00.000Z"));
+    }
+
+    DaemonOptions teamOptions() {
+        DaemonOptions options;
+        options.boards = {"Team board"};
+        options.people = {"Alice"};
+        options.start_date = "2020-05-01T00:00:00";
+        options.end_date = "2099-01-01T00:00:00";
+        options.refresh_seconds = 3600;
+        return options;
+    }
+
+    ReportDaemon::ClientFactory factory(const MockJiraServer& server, int& created) {
+        std::string url = server.url();
+        return [url, &created]() {
+            created++;
+            std::unique_ptr<JiraClient> client(new JiraClient(url, std::make_shared<CprTransport>("tester", "token")));
+            SchedulerOptions options;
+            options.requests_per_second = 1000;
+            options.burst = 1000;
+            options.base_backoff = 0.01;
+            client->setRateLimit(options);
+            return client;
+        };
+    }
+
+    HttpRequest get(const std::string& path, const std::map<std::string, std::string>& params = {}) {
+        HttpRequest request;
+        request.method = "GET";
+        request.path = path;
+        request.params = params;
+        return request;
+    }
+
+    // sends raw bytes to the server and reads the answer until the connection is closed
+    std::string exchange(int port, const std::string& data) {
+        int connection = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        std::string answer;
+        if (connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            send(connection, data.data(), data.size(), MSG_NOSIGNAL);
+            char chunk[4096];
+            for (ssize_t received; (received = recv(connection, chunk, sizeof(chunk), 0)) > 0;) {
+                answer.append(chunk, static_cast<size_t>(received));
+            }
+        }
+        close(connection);
+        return answer;
+    }
+}
+
+TEST(ReportDaemon, KeepsClosedSprintsAndRecountsOpenOnes) {
+    MockJiraServer server;
+    fillBoard(server);
+    int created = 0;
+    ReportDaemon daemon(factory(server, created), teamOptions());
+    EXPECT_EQ(daemon.handle(get("/health")).status_code, 503);
+    daemon.refresh();
+    std::string report = daemon.report(ReportFormat::Csv);
+    // header and a row for each sprint, 2 and 1 finished issues
+    EXPECT_NE(report.find(",Sprint 1,"), std::string::npos);
+    EXPECT_NE(report.find(",Alice Smith,0,2,"), std::string::npos);
+    EXPECT_NE(report.find(",Alice Smith,0,1,"), std::string::npos);
+    size_t closed_requests = server.requests("/board/{id}/sprint/{id}/issue");
+
+    server.addIssue(2, MockJiraServer::issue(22, IssueType::Task, ALICE, "2020-06-17T12:00:00.000Z"));
+    daemon.refresh();
+    report = daemon.report(ReportFormat::Csv, "Team board");
+    EXPECT_NE(report.find(",Alice Smith,0,2,"), std::string::npos);
+    EXPECT_EQ(report.find(",Alice Smith,0,1,"), std::string::npos);
+    // only the active sprint was downloaded again, with the same client
+    EXPECT_EQ(server.requests("/board/{id}/sprint/{id}/issue"), closed_requests + 1);
+    EXPECT_EQ(server.requests("/user/search"), 1u);
+    EXPECT_EQ(created, 1);
+    EXPECT_THROW(daemon.report(ReportFormat::Csv, "Other board"), std::invalid_argument);
+}
+
+TEST(ReportDaemon, ResolvesPeopleAfterFailedSearch) {
+    MockJiraServer server;
+    fillBoard(server);
+    int created = 0;
+    DaemonOptions options = teamOptions();
+    options.people = {"Alice", "Carol"};
+    ReportDaemon daemon(factory(server, created), options);
+    EXPECT_THROW(daemon.refresh(), std::invalid_argument);
+    server.addUser("account-carol", "Carol White");
+    daemon.refresh();
+    // people are searched again with a new client, not left empty
+    EXPECT_EQ(created, 2);
+    std::string report = daemon.report(ReportFormat::Csv);
+    EXPECT_NE(report.find(",Alice Smith,0,2,"), std::string::npos);
+    EXPECT_NE(report.find(",Carol White,"), std::string::npos);
+}
+
+TEST(ReportDaemon, RecyclesClient) {
+    MockJiraServer server;
+    fillBoard(server);
+    int created = 0;
+    DaemonOptions options = teamOptions();
+    options.recycle_after = 2;
+    ReportDaemon daemon(factory(server, created), options);
+    for (int i = 0; i < 5; i++) {
+        daemon.refresh();
+    }
+    EXPECT_EQ(created, 3);
+    EXPECT_NE(daemon.report(ReportFormat::Markdown).find("## Sprint 2"), std::string::npos);
+}
+
+TEST(ReportDaemon, ServesHttp) {
+    MockJiraServer server;
+    fillBoard(server);
+    int created = 0;
+    ReportDaemon daemon(factory(server, created), teamOptions());
+    daemon.refresh();
+    HttpResponse response = daemon.handle(get("/report", {{"format", "jsonl"}, {"board", "Team board"}}));
+    EXPECT_EQ(response.status_code, 200);
+    EXPECT_EQ(response.headers["content-type"], "application/x-ndjson");
+    EXPECT_EQ(std::count(response.text.begin(), response.text.end(), '\n'), 2);
+    EXPECT_EQ(daemon.handle(get("/report", {{"format", "xml"}})).status_code, 400);
+    EXPECT_EQ(daemon.handle(get("/report", {{"board", "Other board"}})).status_code, 400);
+    EXPECT_EQ(daemon.handle(get("/health")).status_code, 200);
+    EXPECT_NE(daemon.handle(get("/metrics")).text.find("jira_"), std::string::npos);
+    EXPECT_EQ(daemon.handle(get("/unknown")).status_code, 404);
+
+    // a failed refresh keeps previous results
+    server.stop();
+    EXPECT_ANY_THROW(daemon.refresh());
+    EXPECT_EQ(daemon.handle(get("/report")).status_code, 200);
+    EXPECT_NE(daemon.handle(get("/health")).text.find("\"status\":\"error\""), std::string::npos);
+}
+
+TEST(LocalHttpServer, RejectsBadContentLength) {
+    LocalHttpServer server([](const HttpRequest&) {
+        HttpResponse response;
+        response.status_code = 200;
+        return response;
+    });
+    EXPECT_EQ(exchange(server.port(), "GET /health HTTP/1.1\r\nContent-Length: 12abc\r\n\r\n").find("HTTP/1.1 400"), 0u);
+    EXPECT_EQ(exchange(server.port(), "POST /health HTTP/1.1\r\nContent-Length: 99999999999999999999999\r\n\r\n").find("HTTP/1.1 413"), 0u);
+    EXPECT_EQ(exchange(server.port(), "POST /health HTTP/1.1\r\nContent-Length: 2000000\r\n\r\n").find("HTTP/1.1 413"), 0u);
+    // the server is still there
+    EXPECT_EQ(exchange(server.port(), "POST /health HTTP/1.1\r\nContent-Length: 2\r\nConnection: close\r\n\r\n{}").find("HTTP/1.1 200"), 0u);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "jira/executor.hpp"
+
+TEST(Executor, ReturnsResults) {
+    Executor executor(3);
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; i++) {
+        results.push_back(executor.submit([i]() { return i * i; }));
+    }
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(results[i].get(), i * i);
+    }
+}
+
+TEST(Executor, PassesExceptions) {
+    Executor executor(1);
+    auto result = executor.submit([]() -> int { throw std::logic_error("failed"); });
+    EXPECT_THROW(result.get(), std::logic_error);
+}
+
+TEST(Executor, FinishesTasksBeforeDestruction) {
+    std::atomic<int> finished(0);
+    {
+        Executor executor(2);
+        for (int i = 0; i < 50; i++) {
+            executor.submit([&finished]() { finished++; });
+        }
+    }
+    EXPECT_EQ(finished.load(), 50);
+}
+
+TEST(Executor, WaitRunsSubtasks) {
+    // a single thread would deadlock if a task blocked on its subtasks
+    Executor executor(1);
+    auto total = executor.submit([&executor]() {
+        std::vector<std::future<int>> parts;
+        for (int i = 1; i <= 10; i++) {
+            parts.push_back(executor.submit([i]() { return i; }));
+        }
+        int sum = 0;
+        for (auto& part : parts) {
+            executor.wait(part);
+            sum += part.get();
+        }
+        return sum;
+    });
+    executor.wait(total);
+    EXPECT_EQ(total.get(), 55);
+}
+
+TEST(Executor, IdleThreadStealsSubtasks) {
+    Executor executor(2);
+    std::atomic<bool> stolen(false);
+    auto owner = executor.submit([&executor, &stolen]() {
+        // the subtask is queued on this thread, which is busy until another thread takes it
+        executor.submit([&stolen]() { stolen = true; });
+        for (int i = 0; i < 2000 && !stolen; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return stolen.load();
+    });
+    EXPECT_TRUE(owner.get());
+}
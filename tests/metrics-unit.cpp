@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include "jira/metrics.hpp"
+
+TEST(Metrics, Endpoint) {
+    EXPECT_EQ(Metrics::endpoint("https://jira.example.com/rest/agile/1.0/board/12/sprint/345/issue?startAt=0"), "/rest/agile/1.0/board/{id}/sprint/{id}/issue");
+    EXPECT_EQ(Metrics::endpoint("https://jira.example.com/rest/api/3/user/search"), "/rest/api/3/user/search");
+    EXPECT_EQ(Metrics::endpoint("https://jira.example.com"), "/");
+}
+
+TEST(Metrics, JsonExport) {
+    Metrics metrics;
+    metrics.recordRequest("https://jira/rest/agile/1.0/board/1/sprint", 200, 0.02, 1000);
+    metrics.recordRequest("https://jira/rest/agile/1.0/board/2/sprint", 429, 20, 10);
+    metrics.recordMapping("issue", 0.5, 200);
+    metrics.recordAggregation(0.1);
+    auto exported = metrics.toJSON();
+    const auto& sprints = exported.at("requests").at("/rest/agile/1.0/board/{id}/sprint");
+    EXPECT_EQ(sprints.at("bytes").get<int>(), 1010);
+    EXPECT_EQ(sprints.at("errors").get<int>(), 1);
+    EXPECT_EQ(sprints.at("seconds").at("count").get<int>(), 2);
+    EXPECT_EQ(sprints.at("seconds").at("buckets").at("0.025").get<int>(), 1);
+    EXPECT_EQ(sprints.at("seconds").at("buckets").at("+Inf").get<int>(), 1);
+    EXPECT_EQ(exported.at("objects").at("issue").at("count").get<int>(), 200);
+    EXPECT_EQ(exported.at("aggregation").at("count").get<int>(), 1);
+}
+
+TEST(Metrics, PrometheusExport) {
+    Metrics metrics;
+    metrics.recordRequest("https://jira/rest/api/3/myself", 200, 0.02, 100);
+    metrics.recordRequest("https://jira/rest/api/3/myself", 200, 0.2, 100);
+    std::string text = metrics.toPrometheus();
+    EXPECT_NE(text.find("jira_request_duration_seconds_bucket{endpoint=\"/rest/api/3/myself\",le=\"0.025\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("jira_request_duration_seconds_bucket{endpoint=\"/rest/api/3/myself\",le=\"+Inf\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("jira_response_bytes_total{endpoint=\"/rest/api/3/myself\"} 200\n"), std::string::npos);
+    EXPECT_NE(text.find("jira_json_parse_seconds_count 0\n"), std::string::npos);
+}
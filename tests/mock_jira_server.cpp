@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+#include "mock_jira_server.hpp"
+#include "utils.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    const std::string API = "/rest/api/3";
+    const std::string AGILE = "/rest/agile/1.0";
+
+    HttpResponse reply(long status_code, const std::string& text) {
+        HttpResponse response;
+        response.status_code = status_code;
+        response.text = text;
+        return response;
+    }
+
+    std::string lowerCase(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+        return text;
+    }
+
+    // numbers in the path are replaced with {id}: /board/12/sprint/5/issue -> /board/{id}/sprint/{id}/issue, {12, 5}
+    std::string endpoint(const std::string& path, std::vector<int>& ids) {
+        std::string result;
+        for (size_t begin = 0; begin < path.size();) {
+            size_t end = std::min(path.find('/', begin + 1), path.size());
+            std::string segment = path.substr(begin + 1, end - begin - 1);
+            if (!segment.empty() && std::all_of(segment.begin(), segment.end(), [](unsigned char c) { return std::isdigit(c); })) {
+                ids.push_back(std::stoi(segment));
+                segment = "{id}";
+            }
+            result += "/" + segment;
+            begin = end;
+        }
+        return result;
+    }
+
+    bool endsWith(const std::string& text, const std::string& suffix) {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    std::string now() {
+        time_t time = std::time(nullptr);
+        std::tm date = {};
+        gmtime_r(&time, &date);
+        char buffer[32];
+        strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S.000+0000", &date);
+        return buffer;
+    }
+
+    // the only JQL understood is "updated >= -<N>m", anywhere in the query
+    time_t updatedSince(const HttpRequest& request) {
+        const std::string clause = "updated >= -";
+        std::string jql = request.params.count("jql") ? request.params.at("jql") : "";
+        size_t found = jql.find(clause);
+        if (found == std::string::npos) {
+            return 0;
+        }
+        return std::time(nullptr) - std::stol(jql.substr(found + clause.size())) * 60;
+    }
+}
+
+MockJiraServer::MockJiraServer(const MockOptions options) {
+    this->options = options;
+    server = std::unique_ptr<LocalHttpServer>(new LocalHttpServer([this](const HttpRequest& request) {
+        return handle(request);
+    }));
+}
+
+std::string MockJiraServer::url() const {
+    return server->url();
+}
+
+void MockJiraServer::stop() {
+    server->stop();
+}
+
+void MockJiraServer::addUser(const std::string& account_id, const std::string& name) {
+    std::lock_guard<std::mutex> guard(mutex);
+    users.push_back({{"accountId", account_id}, {"displayName", name}});
+}
+
+void MockJiraServer::addBoard(int board_id, const std::string& name) {
+    std::lock_guard<std::mutex> guard(mutex);
+    boards[board_id] = {{"id", board_id}, {"name", name}, {"type", "scrum"}};
+}
+
+void MockJiraServer::addSprint(int board_id, int sprint_id, const std::string& name, const std::string& state,
+    const std::string& start_date, const std::string& end_date, const std::string& complete_date) {
+    std::lock_guard<std::mutex> guard(mutex);
+    json sprint = {
+        {"id", sprint_id},
+        {"name", name},
+        {"state", state},
+        {"originBoardId", board_id},
+        {"startDate", start_date},
+        {"endDate", end_date}};
+    if (!complete_date.empty()) {
+        sprint["completeDate"] = complete_date;
+    }
+    sprints[sprint_id] = sprint;
+    issues[sprint_id] = json::array();
+}
+
+void MockJiraServer::addIssue(int sprint_id, const json& issue) {
+    std::lock_guard<std::mutex> guard(mutex);
+    json stored = issue;
+    stored["fields"]["sprint"] = {{"id", sprint_id}, {"state", sprints.at(sprint_id).at("state")}};
+    issues[sprint_id].push_back(stored);
+}
+
+void MockJiraServer::updateIssue(int sprint_id, const json& issue) {
+    json updated = issue;
+    updated["fields"]["updated"] = now();
+    std::lock_guard<std::mutex> guard(mutex);
+    int board_id = 0;
+    auto removeFrom = [&updated](json& list) {
+        size_t size = list.size();
+        json kept = json::array();
+        for (const auto& stored : list) {
+            if (stored.at("id") != updated.at("id")) {
+                kept.push_back(stored);
+            }
+        }
+        list = kept;
+        return kept.size() != size;
+    };
+    for (auto& sprint : issues) {
+        if (removeFrom(sprint.second)) {
+            board_id = sprints.at(sprint.first).at("originBoardId");
+        }
+    }
+    for (auto& backlog : backlogs) {
+        if (removeFrom(backlog.second)) {
+            board_id = backlog.first;
+        }
+    }
+    if (sprint_id != 0) {
+        updated["fields"]["sprint"] = {{"id", sprint_id}, {"state", sprints.at(sprint_id).at("state")}};
+        issues[sprint_id].push_back(updated);
+    } else {
+        updated["fields"]["sprint"] = nullptr;
+        backlogs[board_id].push_back(updated);
+    }
+}
+
+size_t MockJiraServer::requests(const std::string& suffix) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    size_t count = 0;
+    for (const auto& counter : counters) {
+        if (endsWith(counter.first, suffix)) {
+            count += counter.second;
+        }
+    }
+    return count;
+}
+
+size_t MockJiraServer::throttled() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return throttled_count;
+}
+
+json MockJiraServer::issue(int id, int type_id, const std::string& assignee, const std::string& resolution_date,
+    const std::vector<std::pair<std::string, std::string>>& comments) {
+    json comment_list = json::array();
+    for (size_t i = 0; i < comments.size(); i++) {
+        comment_list.push_back({
+            {"id", std::to_string(id * 100 + i)},
+            {"author", {{"accountId", comments[i].first}}},
+            {"created", comments[i].second},
+            {"body", "Comment " + std::to_string(i)}});
+    }
+    return {
+        {"id", std::to_string(id)},
+        {"key", "TEST-" + std::to_string(id)},
+        {"fields", {
+            {"summary", "Issue " + std::to_string(id)},
+            {"issuetype", {{"id", std::to_string(type_id)}, {"subtask", type_id == 10001}}},
+            {"assignee", assignee.empty() ? json(nullptr) : json{{"accountId", assignee}}},
+            {"status", {{"id", "1"}, {"name", resolution_date.empty() ? "To Do" : "Done"}}},
+            {"resolution", resolution_date.empty() ? json(nullptr) : json{{"name", "Done"}}},
+            {"resolutiondate", resolution_date.empty() ? json(nullptr) : json(resolution_date)},
+            {"updated", "2020-06-01T10:00:00.000+0000"},
+            {"customfield_10125", 1},
+            {"subtasks", json::array()},
+            {"comment", {{"comments", comment_list}}}}}};
+}
+
+HttpResponse MockJiraServer::page(const HttpRequest& request, const json& items, const std::string& items_key) const {
+    size_t start_at = request.params.count("startAt") ? std::stoul(request.params.at("startAt")) : 0;
+    size_t max_results = request.params.count("maxResults") ? std::stoul(request.params.at("maxResults")) : 50;
+    max_results = std::min(max_results, options.page_size);
+    json values = json::array();
+    for (size_t i = start_at; i < items.size() && i < start_at + max_results; i++) {
+        values.push_back(items[i]);
+    }
+    json result = {
+        {"startAt", start_at},
+        {"maxResults", max_results},
+        {"total", items.size()},
+        {items_key, values}};
+    if (items_key == "values") {
+        result["isLast"] = start_at + values.size() >= items.size();
+    }
+    return reply(200, result.dump());
+}
+
+HttpResponse MockJiraServer::handle(const HttpRequest& request) {
+    if (options.latency_ms > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.latency_ms));
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    received++;
+    if (options.throttle_every > 0 && received % options.throttle_every == 0) {
+        throttled_count++;
+        HttpResponse response = reply(429, "{\"errorMessages\":[\"Rate limit exceeded\"]}");
+        response.headers["Retry-After"] = options.retry_after;
+        return response;
+    }
+    const std::string& path = request.path;
+    std::vector<int> ids;
+    std::string route = endpoint(path, ids);
+    counters[route]++;
+
+    if (path == API + "/myself") {
+        return reply(200, json({{"accountId", "tester"}, {"displayName", "Test User"}}).dump());
+    }
+    if (path == API + "/user") {
+        std::string account_id = request.params.count("accountId") ? request.params.at("accountId") : "";
+        for (const auto& user : users) {
+            if (user.at("accountId") == account_id) {
+                return reply(200, user.dump());
+            }
+        }
+        return reply(404, "{\"errorMessages\":[\"User not found\"]}");
+    }
+    if (path == API + "/user/search") {
+        std::string query = lowerCase(request.params.count("query") ? request.params.at("query") : "");
+        json found = json::array();
+        for (const auto& user : users) {
+            if (lowerCase(user.at("displayName").get<std::string>()).find(query) != std::string::npos) {
+                found.push_back(user);
+            }
+        }
+        return reply(200, found.dump());
+    }
+    if (route == AGILE + "/board") {
+        json values = json::array();
+        for (const auto& board : boards) {
+            values.push_back(board.second);
+        }
+        return page(request, values, "values");
+    }
+    if (route == AGILE + "/board/{id}/sprint") {
+        std::string states = request.params.count("state") ? request.params.at("state") : "";
+        json values = json::array();
+        for (const auto& sprint : sprints) {
+            bool state_matches = states.empty() || states.find(sprint.second.at("state").get<std::string>()) != std::string::npos;
+            if (sprint.second.at("originBoardId") == ids[0] && state_matches) {
+                values.push_back(sprint.second);
+            }
+        }
+        return page(request, values, "values");
+    }
+    if (route == AGILE + "/sprint/{id}") {
+        auto found = sprints.find(ids[0]);
+        return found != sprints.end() ? reply(200, found->second.dump()) : reply(404, "{}");
+    }
+    if (route == AGILE + "/board/{id}/sprint/{id}/issue") {
+        auto found = issues.find(ids[1]);
+        return found != issues.end() ? page(request, found->second, "issues") : reply(404, "{}");
+    }
+    if (route == AGILE + "/board/{id}/issue") {
+        time_t since = updatedSince(request);
+        auto isUpdated = [since](const json& issue) {
+            return Utils::parseTimestapm(issue.at("fields").at("updated").get<std::string>()) >= since;
+        };
+        json values = json::array();
+        for (const auto& sprint : sprints) {
+            if (sprint.second.at("originBoardId") == ids[0]) {
+                for (const auto& issue : issues.at(sprint.first)) {
+                    if (isUpdated(issue)) {
+                        values.push_back(issue);
+                    }
+                }
+            }
+        }
+        if (backlogs.count(ids[0])) {
+            for (const auto& issue : backlogs.at(ids[0])) {
+                if (isUpdated(issue)) {
+                    values.push_back(issue);
+                }
+            }
+        }
+        return page(request, values, "issues");
+    }
+    return reply(404, "{\"errorMessages\":[\"Not found\"]}");
+}
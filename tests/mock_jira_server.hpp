@@ -0,0 +1,103 @@
+/**
+ * @file mock_jira_server.hpp
+ * @author Sergey Serebryanskiy (serebryanskiysergei@gmail.com)
+ * @brief Local stand-in for Jira Cloud REST and Agile APIs used in tests
+ * @version 0.1
+ * @date 2020-07-05
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef MOCK_JIRA_SERVER_H_
+#define MOCK_JIRA_SERVER_H_
+
+#include <jira/local_server.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Behaviour of the MockJiraServer
+ */
+struct MockOptions {
+    int latency_ms = 0;             /** < Delay before every response */
+    int throttle_every = 0;         /** < Every N-th request is answered with 429, 0 to never throttle */
+    std::string retry_after = "0";  /** < Retry-After header of throttled responses */
+    size_t page_size = 2;           /** < Max items per page, whatever maxResults asks */
+};
+
+/**
+ * @brief Jira with in-memory users, boards, sprints and issues on localhost
+ *
+ * Serves the endpoints used by JiraClient with Jira's pagination. Counts requests
+ * by endpoint, so tests can check what was (not) requested.
+ */
+class MockJiraServer {
+    public:
+        explicit MockJiraServer(const MockOptions options = MockOptions());
+
+        std::string url() const;
+        void stop();
+
+        void addUser(const std::string& account_id, const std::string& name);
+        void addBoard(int board_id, const std::string& name);
+        void addSprint(int board_id, int sprint_id, const std::string& name, const std::string& state,
+            const std::string& start_date, const std::string& end_date, const std::string& complete_date = "");
+        void addIssue(int sprint_id, const nlohmann::json& issue);
+
+        /**
+         * @brief Replace an issue wherever it is and put it into a sprint
+         *
+         * The issue gets the current time as its `updated` field, so it is found
+         * by delta sync queries like `updated >= -5m`.
+         *
+         * @param [in] sprint_id new sprint of the issue, 0 to move it into the backlog of its board
+         * @param [in] issue the issue, matched by its id
+         */
+        void updateIssue(int sprint_id, const nlohmann::json& issue);
+
+        /**
+         * @brief Number of answered (not throttled) requests whose path ends with `suffix`
+         */
+        size_t requests(const std::string& suffix) const;
+
+        /**
+         * @brief Number of requests answered with 429
+         */
+        size_t throttled() const;
+
+        /**
+         * @brief Build an issue in the format of the agile API
+         *
+         * @param [in] id ID of the issue, the key is "TEST-<id>"
+         * @param [in] type_id ID of the issue type (see IssueType)
+         * @param [in] assignee account id, empty for unassigned
+         * @param [in] resolution_date resolution date, empty for not resolved
+         * @param [in] comments pairs of author account id and creation date
+         * @return nlohmann::json the issue
+         */
+        static nlohmann::json issue(int id, int type_id, const std::string& assignee, const std::string& resolution_date,
+            const std::vector<std::pair<std::string, std::string>>& comments = {});
+
+    private:
+        HttpResponse handle(const HttpRequest& request);
+        HttpResponse page(const HttpRequest& request, const nlohmann::json& items, const std::string& items_key) const;
+
+        MockOptions options;
+        mutable std::mutex mutex;
+        nlohmann::json users = nlohmann::json::array();
+        std::map<int, nlohmann::json> boards;
+        std::map<int, nlohmann::json> sprints;
+        std::map<int, nlohmann::json> issues;     /** < sprint id -> issues */
+        std::map<int, nlohmann::json> backlogs;   /** < board id -> issues without a sprint */
+        std::map<std::string, size_t> counters;
+        size_t received = 0;
+        size_t throttled_count = 0;
+        std::unique_ptr<LocalHttpServer> server;
+};
+
+#endif // MOCK_JIRA_SERVER_H_
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include "jira/pagination.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    // pages of 2 issues out of `total`, startAt beyond `failing_from` throws
+    PageIterator::PageLoader loader(std::atomic<int>& calls, int total, int failing_from = 1 << 30) {
+        return [&calls, total, failing_from](int start_at) -> std::string {
+            calls++;
+            if (start_at >= failing_from) {
+                throw std::runtime_error("Page is not available");
+            }
+            json issues = json::array();
+            for (int i = start_at; i < total && i < start_at + 2; i++) {
+                issues.push_back({{"id", std::to_string(i)}});
+            }
+            return json({{"startAt", start_at}, {"maxResults", 2}, {"total", total}, {"issues", issues}}).dump();
+        };
+    }
+}
+
+TEST(PageIterator, SkipsItems) {
+    std::atomic<int> calls(0);
+    PageIterator pages(loader(calls, 5), "issues");
+    pages.skip(1);
+    std::string ids;
+    while (pages.next()) {
+        for (const auto& item : pages.items()) {
+            ids += item.at("id").get<std::string>();
+        }
+    }
+    EXPECT_EQ(ids, "1234");
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(PageIterator, LoaderFailsOnSecondPage) {
+    std::atomic<int> calls(0);
+    PageIterator pages(loader(calls, 4, 2), "issues");
+    ASSERT_TRUE(pages.next());
+    EXPECT_EQ(pages.items().size(), 2u);
+    EXPECT_THROW(pages.next(), std::runtime_error);
+    // the failed prefetch is reported again, not read from an empty future
+    EXPECT_THROW(pages.next(), std::runtime_error);
+    EXPECT_EQ(calls, 2);
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+#include <nlohmann/json.hpp>
+
+#include "report/report.hpp"
+
+namespace {
+    ReportRow makeRow(int sprint_id, const std::string& sprint, const std::string& person) {
+        ReportRow row;
+        row.sprint_id = sprint_id;
+        row.sprint = sprint;
+        row.account_id = "account-" + person;
+        row.person = person;
+        row.finished.issues = 2;
+        row.finished.story_points = 5;
+        row.comments = 3;
+        row.reviewed = 1;
+        return row;
+    }
+
+    size_t countLines(const std::string& text) {
+        return std::count(text.begin(), text.end(), '\n');
+    }
+}
+
+TEST(ReportWriter, Csv) {
+    std::ostringstream out;
+    auto writer = ReportWriter::create(ReportFormat::Csv, out);
+    writer->write(makeRow(1, "Sprint 1", "Alice"));
+    writer->write(makeRow(1, "Sprint 1", "Smith, \"Bob\""));
+    writer->finish();
+    std::string report = out.str();
+    EXPECT_EQ(countLines(report), 3u);
+    EXPECT_EQ(report.find("board_id,sprint_id,sprint,"), 0u);
+    EXPECT_NE(report.find(",\"Smith, \"\"Bob\"\"\","), std::string::npos);
+    EXPECT_EQ(writer->rows(), 2u);
+}
+
+TEST(ReportWriter, JsonLines) {
+    std::ostringstream out;
+    auto writer = ReportWriter::create(ReportWriter::formatFromName("jsonl"), out);
+    writer->write(makeRow(1, "Sprint 1", "Alice"));
+    writer->write(makeRow(2, "Sprint 2", "Alice"));
+    writer->finish();
+    std::istringstream lines(out.str());
+    std::string line;
+    int sprint_id = 0;
+    while (std::getline(lines, line)) {
+        nlohmann::json row = nlohmann::json::parse(line);
+        EXPECT_EQ(row.at("sprint_id").get<int>(), ++sprint_id);
+        EXPECT_EQ(row.at("story_points").get<int>(), 5);
+        EXPECT_EQ(row.at("person").get<std::string>(), "Alice");
+    }
+    EXPECT_EQ(sprint_id, 2);
+}
+
+TEST(ReportWriter, MarkdownTablePerSprint) {
+    std::ostringstream out;
+    auto writer = ReportWriter::create(ReportFormat::Markdown, out);
+    writer->write(makeRow(1, "Sprint 1", "Alice"));
+    writer->write(makeRow(1, "Sprint 1", "A|B"));
+    writer->write(makeRow(2, "Sprint 2", "Alice"));
+    writer->finish();
+    std::string report = out.str();
+    EXPECT_NE(report.find("## Sprint 1\n"), std::string::npos);
+    EXPECT_NE(report.find("\n## Sprint 2\n"), std::string::npos);
+    EXPECT_NE(report.find("| A\\|B | 0 | 2 |"), std::string::npos);
+    EXPECT_THROW(ReportWriter::formatFromName("xml"), std::invalid_argument);
+}
+
+TEST(ReportWriter, StreamsWhenBufferIsFull) {
+    std::ostringstream out;
+    auto writer = ReportWriter::create(ReportFormat::JsonLines, out, 256);
+    for (int i = 0; i < 10; i++) {
+        writer->write(makeRow(i, "Sprint", "Alice"));
+    }
+    // full buffers were written out, the rest is kept until finish()
+    size_t streamed = out.str().size();
+    EXPECT_GT(streamed, 0u);
+    writer.reset();
+    EXPECT_GT(out.str().size(), streamed);
+    EXPECT_EQ(countLines(out.str()), 10u);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <deque>
+#include <stdexcept>
+
+#include "jira/scheduler.hpp"
+
+namespace {
+    // answers with scripted status codes, then with 200
+    class ScriptedTransport : public Transport {
+        public:
+            std::deque<long> statuses;
+            std::string retry_after;
+
+            HttpResponse get(const std::string&, const std::map<std::string, std::string>&) override {
+                HttpResponse response;
+                response.status_code = 200;
+                if (!statuses.empty()) {
+                    response.status_code = statuses.front();
+                    statuses.pop_front();
+                }
+                if ((response.status_code == 429 || response.status_code == 503) && !retry_after.empty()) {
+                    response.headers["retry-after"] = retry_after;
+                }
+                return response;
+            }
+    };
+
+    class FailingTransport : public Transport {
+        public:
+            HttpResponse get(const std::string&, const std::map<std::string, std::string>&) override {
+                throw std::runtime_error("Recorded response is damaged");
+            }
+    };
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+TEST(RequestScheduler, RetryAfterSeconds) {
+    EXPECT_EQ(RequestScheduler::retryAfter("120", 0), 120);
+    EXPECT_EQ(RequestScheduler::retryAfter("0", 0), 0);
+}
+
+TEST(RequestScheduler, RetryAfterDate) {
+    // Wed, 21 Oct 2015 07:28:00 GMT
+    const time_t date = 1445412480;
+    EXPECT_EQ(RequestScheduler::retryAfter("Wed, 21 Oct 2015 07:28:00 GMT", date - 30), 30);
+    EXPECT_EQ(RequestScheduler::retryAfter("Wed, 21 Oct 2015 07:28:00 GMT", date + 30), 0);
+}
+
+TEST(RequestScheduler, RetryAfterIncorrect) {
+    EXPECT_LT(RequestScheduler::retryAfter("", 0), 0);
+    EXPECT_LT(RequestScheduler::retryAfter("soon", 0), 0);
+    EXPECT_LT(RequestScheduler::retryAfter("-5", 0), 0);
+}
+
+TEST(RequestScheduler, TokenBucketPacing) {
+    ScriptedTransport transport;
+    SchedulerOptions options;
+    options.requests_per_second = 50;
+    options.burst = 1;
+    RequestScheduler scheduler(transport, options);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 11; i++) {
+        EXPECT_EQ(scheduler.get("http://jira").status_code, 200);
+    }
+    // the first request takes the only token, the next 10 wait 20 ms each
+    EXPECT_GE(secondsSince(start), 0.18);
+    EXPECT_EQ(scheduler.stats().requests, 11u);
+}
+
+TEST(RequestScheduler, AdditiveIncreaseMultiplicativeDecrease) {
+    ScriptedTransport transport;
+    SchedulerOptions options;
+    options.requests_per_second = 1000;
+    options.burst = 1000;
+    options.base_backoff = 0.001;
+    options.min_concurrency = 1;
+    options.max_concurrency = 8;
+    RequestScheduler scheduler(transport, options);
+    EXPECT_EQ(scheduler.stats().concurrency, 1);
+    for (int i = 0; i < 3; i++) {
+        scheduler.get("http://jira");
+    }
+    // 1 -> 2 -> 2.5 -> 2.9
+    EXPECT_NEAR(scheduler.stats().concurrency, 2.9, 1e-9);
+    transport.statuses = {503};
+    EXPECT_EQ(scheduler.get("http://jira").status_code, 200);
+    // halved by 503, then the retry adds 1 / 1.45
+    EXPECT_NEAR(scheduler.stats().concurrency, 1.45 + 1 / 1.45, 1e-9);
+    transport.statuses = {503, 503, 503, 503};
+    scheduler.get("http://jira");
+    EXPECT_NEAR(scheduler.stats().concurrency, 2, 1e-9);
+    for (int i = 0; i < 200; i++) {
+        scheduler.get("http://jira");
+    }
+    EXPECT_EQ(scheduler.stats().concurrency, 8);
+}
+
+TEST(RequestScheduler, RetryAfterIsLimited) {
+    ScriptedTransport transport;
+    transport.statuses = {429};
+    transport.retry_after = "3600";
+    SchedulerOptions options;
+    options.max_backoff = 0.05;
+    RequestScheduler scheduler(transport, options);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(scheduler.get("http://jira").status_code, 200);
+    EXPECT_LT(secondsSince(start), 1);
+    EXPECT_EQ(scheduler.stats().throttled, 1u);
+}
+
+TEST(RequestScheduler, RetryAfterOfOverloadedServer) {
+    ScriptedTransport transport;
+    transport.statuses = {503};
+    transport.retry_after = "1";
+    SchedulerOptions options;
+    options.base_backoff = 0.001;
+    options.max_backoff = 0.3;
+    RequestScheduler scheduler(transport, options);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(scheduler.get("http://jira").status_code, 200);
+    // the header is honoured (up to max_backoff) instead of the 1 ms backoff
+    EXPECT_GE(secondsSince(start), 0.25);
+    EXPECT_EQ(scheduler.stats().throttled, 0u);
+}
+
+TEST(RequestScheduler, TransportExceptionReleasesSlot) {
+    FailingTransport transport;
+    SchedulerOptions options;
+    options.min_concurrency = 1;
+    options.max_concurrency = 1;
+    RequestScheduler scheduler(transport, options);
+    // with a leaked slot the second request would wait forever
+    EXPECT_THROW(scheduler.get("http://jira"), std::runtime_error);
+    EXPECT_THROW(scheduler.get("http://jira"), std::runtime_error);
+    EXPECT_EQ(scheduler.stats().requests, 2u);
+}
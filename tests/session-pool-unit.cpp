@@ -0,0 +1,21 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "jira/session_pool.hpp"
+#include "mock_jira_server.hpp"
+
+TEST(SessionPool, SequentialRequestsReuseSession) {
+    MockJiraServer server;
+    SessionOptions options;
+    options.max_idle = 2;
+    SessionPool pool("tester", "token", options);
+    const int count = 20;
+    for (int i = 0; i < count; i++) {
+        HttpResponse response = pool.get(server.url() + "/rest/api/3/myself");
+        ASSERT_EQ(response.status_code, 200) << response.error;
+    }
+    EXPECT_EQ(server.requests("/myself"), static_cast<size_t>(count));
+    // every request puts its session back, so the next one takes it instead of opening another
+    EXPECT_LE(pool.opened(), options.max_idle);
+    EXPECT_EQ(pool.opened(), 1u);
+}
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "jira/snapshot.hpp"
+
+namespace {
+    JiraIssue* makeIssue(JiraArena& arena, const std::string& id, IssueType type, const std::string& assignee,
+        int story_points, time_t resolution_date) {
+        JiraIssue* issue = arena.issues.create();
+        issue->id = id;
+        issue->key = "TEST-" + id;
+        issue->title = "Issue " + id;
+        issue->type = type;
+        issue->assignee = AccountIndex::intern(assignee);
+        issue->status = IssueStatus{"10001", "Done"};
+        issue->story_points = story_points;
+        issue->resolved = resolution_date >= 0;
+        issue->resolution_date = resolution_date;
+        return issue;
+    }
+
+    JiraSprint* makeSprint(JiraArena& arena) {
+        JiraSprint* sprint = arena.sprints.create();
+        sprint->id = 42;
+        sprint->board_id = 7;
+        sprint->name = "Sprint 42";
+        sprint->start_date = 1000;
+        sprint->end_date = 2000;
+        sprint->complete_date = 2001;
+        sprint->is_closed = true;
+        JiraIssue* story = makeIssue(arena, "1", Story, "snapshot-alice", 5, 1500);
+        story->subtasks_ids = {"3", "4"};
+        Comment comment;
+        comment.id = "100";
+        comment.author = AccountIndex::intern("snapshot-bob");
+        comment.text = "Looks good";
+        comment.preview = "Looks good";
+        comment.length = 10;
+        comment.lines = 1;
+        comment.published_date = 1600;
+        story->comments.push_back(comment);
+        sprint->issues.push_back(story);
+        sprint->issues.push_back(makeIssue(arena, "2", Bug, "snapshot-bob", 0, 2500));
+        sprint->issues.push_back(makeIssue(arena, "3", Subtask, "snapshot-alice", 0, 1200));
+        sprint->issues.push_back(makeIssue(arena, "4", Task, "", 3, -1));
+        return sprint;
+    }
+
+    std::string savedSnapshot(const std::string& name) {
+        JiraArena arena;
+        JiraSprint* other = arena.sprints.create();
+        other->id = 41;
+        other->board_id = 7;
+        other->name = "Sprint 41";
+        SnapshotWriter writer;
+        writer.add(*other);
+        writer.add(*makeSprint(arena));
+        std::string path = testing::TempDir() + name;
+        writer.save(path);
+        return path;
+    }
+}
+
+TEST(Snapshot, RoundTrip) {
+    std::string path = savedSnapshot("snapshot-round-trip.bin");
+    SnapshotView view(path);
+    ASSERT_EQ(view.sprintCount(), 2u);
+    EXPECT_EQ(view.issueCount(), 4u);
+    EXPECT_EQ(view.findSprint(41), 0);
+    EXPECT_EQ(view.findSprint(43), -1);
+    int index = view.findSprint(42);
+    ASSERT_EQ(index, 1);
+    const SnapshotSprint& sprint = view.sprint(index);
+    EXPECT_STREQ(view.data(sprint.name), "Sprint 42");
+    EXPECT_EQ(sprint.board_id, 7);
+    EXPECT_EQ(sprint.end_date, 2000);
+    EXPECT_EQ(sprint.closed, 1);
+    ASSERT_EQ(sprint.issue_count, 4u);
+    const SnapshotIssue& story = view.issue(sprint.first_issue);
+    EXPECT_EQ(view.string(story.key), "TEST-1");
+    EXPECT_EQ(view.string(story.assignee), "snapshot-alice");
+    EXPECT_EQ(story.type, Story);
+    ASSERT_EQ(story.comment_count, 1u);
+    EXPECT_EQ(view.string(view.comment(story.first_comment).author), "snapshot-bob");
+    ASSERT_EQ(story.subtask_count, 2u);
+    EXPECT_EQ(view.string(view.subtask(story.first_subtask + 1)), "4");
+    // equal strings are stored once
+    EXPECT_EQ(story.status_name.offset, view.issue(sprint.first_issue + 1).status_name.offset);
+    EXPECT_THROW(view.sprint(2), std::out_of_range);
+    std::remove(path.c_str());
+}
+
+TEST(Snapshot, ColumnsCountLikeSprint) {
+    std::string path = savedSnapshot("snapshot-columns.bin");
+    SnapshotView view(path);
+    JiraArena arena;
+    JiraSprint* sprint = makeSprint(arena);
+    std::vector<AccountHandle> people = {AccountIndex::intern("snapshot-alice"), AccountIndex::intern("snapshot-bob")};
+    std::vector<PersonTally> expected = SprintColumns::fromSprint(*sprint).countFinished(people, sprint->end_date);
+    std::vector<PersonTally> tallies = view.columns(1).countFinished(people, sprint->end_date);
+    ASSERT_EQ(tallies.size(), expected.size());
+    for (size_t i = 0; i < tallies.size(); i++) {
+        EXPECT_EQ(tallies[i].issues, expected[i].issues);
+        EXPECT_EQ(tallies[i].subtasks, expected[i].subtasks);
+        EXPECT_EQ(tallies[i].bugs, expected[i].bugs);
+        EXPECT_EQ(tallies[i].story_points, expected[i].story_points);
+    }
+    EXPECT_EQ(tallies[0].issues + tallies[0].subtasks, 2);
+    std::remove(path.c_str());
+}
+
+TEST(Snapshot, ToSprint) {
+    std::string path = savedSnapshot("snapshot-to-sprint.bin");
+    SnapshotView view(path);
+    JiraArena arena;
+    JiraSprint* sprint = view.toSprint(view.findSprint(42), &arena);
+    EXPECT_EQ(sprint->name, "Sprint 42");
+    EXPECT_TRUE(sprint->is_closed);
+    ASSERT_EQ(sprint->issues.size(), 4u);
+    const JiraIssue* story = sprint->issues[0];
+    EXPECT_EQ(story->status.name, "Done");
+    EXPECT_EQ(story->assignee, AccountIndex::intern("snapshot-alice"));
+    EXPECT_EQ(story->subtasks_ids, std::vector<std::string>({"3", "4"}));
+    ASSERT_EQ(story->comments.size(), 1u);
+    EXPECT_EQ(story->comments[0].text, "Looks good");
+    EXPECT_EQ(story->comments[0].published_date, 1600);
+    EXPECT_EQ(sprint->issues[3]->assignee, NO_ACCOUNT);
+    EXPECT_FALSE(sprint->issues[3]->resolved);
+    EXPECT_EQ(arena.issues.size(), 4u);
+    std::remove(path.c_str());
+}
+
+TEST(Snapshot, RejectsDamagedFiles) {
+    std::string path = savedSnapshot("snapshot-damaged.bin");
+    std::string content;
+    {
+        std::ifstream file(path, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    std::string damaged = content;
+    damaged[0] = 'X';
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << damaged;
+    EXPECT_THROW(SnapshotView view(path), std::runtime_error);
+    // the string table is cut off
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content.substr(0, content.size() - 8);
+    EXPECT_THROW(SnapshotView view(path), std::runtime_error);
+    EXPECT_THROW(SnapshotView view(path + ".missing"), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(Snapshot, ChecksRecordsWhenRead) {
+    std::string path = savedSnapshot("snapshot-damaged-record.bin");
+    std::string content;
+    {
+        std::ifstream file(path, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    SnapshotHeader header;
+    std::memcpy(&header, content.data(), sizeof(header));
+    SnapshotIssue issue;
+    std::memcpy(&issue, content.data() + header.issues_offset, sizeof(issue));
+    issue.type = 12345;
+    issue.key.offset = 0xFFFFFF;
+    std::memcpy(&content[header.issues_offset], &issue, sizeof(issue));
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    // the file opens, only the damaged issue can't be read
+    SnapshotView view(path);
+    EXPECT_THROW(view.issue(0), std::runtime_error);
+    EXPECT_THROW(view.columns(1), std::runtime_error);
+    JiraArena arena;
+    EXPECT_THROW(view.toSprint(1, &arena), std::runtime_error);
+    EXPECT_EQ(view.issue(1).type, Bug);
+    EXPECT_THROW(view.string(issue.key), std::runtime_error);
+    EXPECT_EQ(view.string(view.sprint(1).name), "Sprint 42");
+    std::remove(path.c_str());
+}
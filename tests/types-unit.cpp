@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "jira/arena.hpp"
+#include "jira/executor.hpp"
+#include "jira/pagination.hpp"
+#include "jira/types.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    json makeIssue(const json& body) {
+        return {
+            {"id", "10001"},
+            {"key", "MPA1-1"},
+            {"fields", {
+                {"summary", "Issue"},
+                {"issuetype", {{"id", "10000"}, {"subtask", false}}},
+                {"status", {{"id", "1"}, {"name", "Done"}}},
+                {"resolution", nullptr},
+                {"comment", {{"comments", {{
+                    {"id", "1"},
+                    {"author", {{"accountId", "reviewer"}}},
+                    {"created", "2020-05-27T10:45:12.000Z"},
+                    {"body", body}}}}}}}}};
+    }
+
+    // Issues with every kind of field the mapping looks at
+    json makePage(int count) {
+        json document = {
+            {"type", "doc"},
+            {"content", {{{"type", "paragraph"}, {"content", {
+                {{"type", "text"}, {"text", "Review: "}},
+                {{"type", "emoji"}, {"attrs", {{"text", ":+1:"}}}}}}}}}};
+        json issues = json::array();
+        for (int i = 0; i < count; i++) {
+            json issue = makeIssue(i % 2 == 0 ? json("plain\ncomment " + std::to_string(i)) : document);
+            issue["id"] = std::to_string(20000 + i);
+            issue["key"] = "MPA1-" + std::to_string(i);
+            json& fields = issue["fields"];
+            if (i % 3 == 0) {
+                fields["resolution"] = {{"id", "1"}};
+                fields["resolutiondate"] = "2020-06-0" + std::to_string(1 + i % 9) + "T10:00:00.000+0300";
+                fields["assignee"] = {{"accountId", "worker-" + std::to_string(i % 4)}};
+            } else {
+                fields["assignee"] = nullptr;
+            }
+            if (i % 4 == 1) {
+                fields["issuetype"] = {{"id", "10001"}, {"subtask", true}};
+                fields["parent"] = {{"id", "20000"}};
+            }
+            fields[STORY_POINTS_FIELD] = i % 5 == 0 ? json(nullptr) : i % 5 == 1 ? json(2.0) : json(i % 8);
+            fields["subtasks"] = {{{"id", std::to_string(30000 + i)}}, {{"id", std::to_string(40000 + i)}}};
+            issues.push_back(issue);
+        }
+        return {{"startAt", 50}, {"maxResults", 200}, {"total", 50 + count}, {"issues", issues}};
+    }
+
+    void expectEqual(const JiraIssue& actual, const JiraIssue& expected) {
+        EXPECT_EQ(actual.id, expected.id);
+        EXPECT_EQ(actual.key, expected.key);
+        EXPECT_EQ(actual.parent_id, expected.parent_id);
+        EXPECT_EQ(actual.type, expected.type);
+        EXPECT_EQ(actual.title, expected.title);
+        EXPECT_EQ(actual.assignee, expected.assignee);
+        EXPECT_EQ(actual.status.id, expected.status.id);
+        EXPECT_EQ(actual.status.name, expected.status.name);
+        EXPECT_EQ(actual.story_points, expected.story_points);
+        EXPECT_EQ(actual.resolved, expected.resolved);
+        EXPECT_EQ(actual.resolution_date, expected.resolution_date);
+        EXPECT_EQ(actual.subtasks_ids, expected.subtasks_ids);
+        ASSERT_EQ(actual.comments.size(), expected.comments.size());
+        for (size_t i = 0; i < actual.comments.size(); i++) {
+            EXPECT_EQ(actual.comments[i].id, expected.comments[i].id);
+            EXPECT_EQ(actual.comments[i].author, expected.comments[i].author);
+            EXPECT_EQ(actual.comments[i].text, expected.comments[i].text);
+            EXPECT_EQ(actual.comments[i].length, expected.comments[i].length);
+            EXPECT_EQ(actual.comments[i].lines, expected.comments[i].lines);
+            EXPECT_EQ(actual.comments[i].preview, expected.comments[i].preview);
+            EXPECT_EQ(actual.comments[i].published_date, expected.comments[i].published_date);
+        }
+    }
+}
+
+TEST(JiraIssue, PlainComment) {
+    std::unique_ptr<JiraIssue> issue(JiraIssue::fromJSON(makeIssue("First line\nсекунда\n\nthird")));
+    ASSERT_EQ(issue->comments.size(), 1u);
+    const Comment& comment = issue->comments[0];
+    EXPECT_EQ(comment.length, 22u);
+    EXPECT_EQ(comment.lines, 3u);
+    EXPECT_EQ(comment.preview, "First line секунда third");
+    EXPECT_TRUE(comment.text.empty());
+    EXPECT_EQ(comment.author, AccountIndex::intern("reviewer"));
+}
+
+TEST(JiraIssue, DocumentComment) {
+    json document = {
+        {"type", "doc"},
+        {"version", 1},
+        {"content", {
+            {{"type", "paragraph"}, {"content", {
+                {{"type", "text"}, {"text", "Looks good, "}},
+                {{"type", "mention"}, {"attrs", {{"id", "42"}, {"text", "@Nikita"}}}},
+                {{"type", "hardBreak"}},
+                {{"type", "text"}, {"text", "but"}}}}},
+            {{"type", "bulletList"}, {"content", {
+                {{"type", "listItem"}, {"content", {
+                    {{"type", "paragraph"}, {"content", {{{"type", "text"}, {"text", "fix tests"}}}}}}}}}}}}}};
+    ParseOptions options;
+    options.comments = CommentMode::Full;
+    options.preview_length = 10;
+    std::unique_ptr<JiraIssue> issue(JiraIssue::fromJSON(makeIssue(document), nullptr, options));
+    ASSERT_EQ(issue->comments.size(), 1u);
+    const Comment& comment = issue->comments[0];
+    EXPECT_EQ(comment.text, "Looks good, @Nikitabutfix tests");
+    EXPECT_EQ(comment.length, comment.text.size());
+    EXPECT_EQ(comment.lines, 3u);
+    EXPECT_EQ(comment.preview, "Looks good");
+}
+
+TEST(JiraIssue, PageParsersAreEquivalent) {
+    json page = makePage(50);
+    ParseOptions options;
+    options.comments = CommentMode::Full;
+    options.issues_per_task = 4;
+    JiraArena arena;
+    std::vector<JiraIssue*> expected;
+    for (const auto& json_issue : page.at("issues")) {
+        expected.push_back(JiraIssue::fromJSON(json_issue, &arena, options));
+    }
+    Executor executor(3);
+    for (JsonParser parser : {JsonParser::Nlohmann, JsonParser::Simdjson}) {
+        options.parser = parser;
+        std::vector<JiraIssue*> issues;
+        PageEnvelope envelope = JiraIssue::fromPage(page.dump(), "issues", issues, &arena, options, &executor);
+        EXPECT_EQ(envelope.start_at, 50);
+        EXPECT_EQ(envelope.received, 50);
+        EXPECT_EQ(envelope.total, 100);
+        EXPECT_EQ(envelope.max_results, 200);
+        EXPECT_EQ(envelope.is_last, -1);
+        ASSERT_EQ(issues.size(), expected.size());
+        for (size_t i = 0; i < issues.size(); i++) {
+            expectEqual(*issues[i], *expected[i]);
+        }
+    }
+}
+
+TEST(JiraIssue, MissingResolutionIsNotResolved) {
+    json page = makePage(3);
+    // only issue 0 is resolved; issue 1 has no resolution fields at all
+    page["issues"][1]["fields"].erase("resolution");
+    for (JsonParser parser : {JsonParser::Nlohmann, JsonParser::Simdjson}) {
+        ParseOptions options;
+        options.parser = parser;
+        JiraArena arena;
+        std::vector<JiraIssue*> issues;
+        JiraIssue::fromPage(page.dump(), "issues", issues, &arena, options);
+        ASSERT_EQ(issues.size(), 3u);
+        EXPECT_TRUE(issues[0]->resolved);
+        EXPECT_FALSE(issues[1]->resolved);
+        EXPECT_EQ(issues[1]->resolution_date, (time_t)(-1));
+        EXPECT_FALSE(issues[2]->resolved);
+    }
+}
+
+TEST(JiraIssue, ParallelMappingKeepsOrderAndErrors) {
+    json page = makePage(30);
+    ParseOptions options;
+    options.issues_per_task = 2;
+    Executor executor(4);
+    JiraArena arena;
+    std::vector<JiraIssue*> issues = JiraIssue::fromJSONArray(page.at("issues"), &arena, options, &executor);
+    ASSERT_EQ(issues.size(), 30u);
+    for (size_t i = 0; i < issues.size(); i++) {
+        EXPECT_EQ(issues[i]->key, "MPA1-" + std::to_string(i));
+    }
+    page["issues"][17].erase("key");
+    EXPECT_THROW(JiraIssue::fromJSONArray(page.at("issues"), &arena, options, &executor), std::exception);
+    for (JsonParser parser : {JsonParser::Nlohmann, JsonParser::Simdjson}) {
+        options.parser = parser;
+        EXPECT_THROW(JiraIssue::fromPage(page.dump(), "issues", issues, &arena, options, &executor), std::exception);
+    }
+}
+
+TEST(ObjectPool, PointersSurviveGrowth) {
+    ObjectPool<JiraIssue> pool;
+    std::vector<JiraIssue*> created;
+    // enough objects for the deque to allocate many blocks and grow its map
+    for (int i = 0; i < 10000; i++) {
+        JiraIssue* issue = pool.create();
+        issue->key = "MPA1-" + std::to_string(i);
+        created.push_back(issue);
+    }
+    EXPECT_EQ(pool.size(), created.size());
+    for (size_t i = 0; i < created.size(); i++) {
+        EXPECT_EQ(created[i]->key, "MPA1-" + std::to_string(i));
+    }
+}
+
+TEST(AccountIndex, EmptyIdIsNoAccount) {
+    EXPECT_EQ(AccountIndex::intern(""), NO_ACCOUNT);
+    EXPECT_EQ(AccountIndex::accountId(NO_ACCOUNT), "");
+    EXPECT_NE(AccountIndex::intern("account-index-test"), NO_ACCOUNT);
+}
+
+TEST(AccountIndex, EqualIdsGetEqualHandlesAcrossThreads) {
+    const size_t ids = 200;
+    std::vector<std::vector<AccountHandle>> handles(8, std::vector<AccountHandle>(ids));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < handles.size(); t++) {
+        threads.emplace_back([&handles, t, ids]() {
+            // threads walk the ids from different places, so first interning of an id races
+            for (size_t n = 0; n < ids; n++) {
+                size_t i = (n + t * 25) % ids;
+                handles[t][i] = AccountIndex::intern("concurrent-" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t i = 0; i < ids; i++) {
+        for (size_t t = 1; t < handles.size(); t++) {
+            EXPECT_EQ(handles[t][i], handles[0][i]);
+        }
+        EXPECT_EQ(AccountIndex::accountId(handles[0][i]), "concurrent-" + std::to_string(i));
+        EXPECT_EQ(AccountIndex::intern("concurrent-" + std::to_string(i)), handles[0][i]);
+    }
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+#include "jira/user_directory.hpp"
+
+namespace {
+    JiraUser makeUser(const std::string& id, const std::string& name) {
+        JiraUser user;
+        user.id = id;
+        user.name = name;
+        return user;
+    }
+}
+
+TEST(UserDirectory, FreshAndStale) {
+    UserDirectory directory;
+    directory.setTtl(3600);
+    directory.add("smith", makeUser("account-smith", "Alice Smith"), 1000);
+    UserDirectory::Entry entry;
+    EXPECT_FALSE(directory.find("brown", entry));
+    ASSERT_TRUE(directory.find("smith", entry));
+    EXPECT_EQ(entry.account_id, "account-smith");
+    EXPECT_TRUE(directory.isFresh(entry, 1000 + 3599));
+    EXPECT_FALSE(directory.isFresh(entry, 1000 + 3600));
+    directory.remove("smith");
+    EXPECT_EQ(directory.size(), 0u);
+}
+
+TEST(UserDirectory, SaveAndLoad) {
+    UserDirectory directory;
+    directory.add("smith", makeUser("account-smith", "Alice Smith"), 1000);
+    directory.add("bob brown", makeUser("account-bob", "Bob Brown"), 2000);
+    std::string path = testing::TempDir() + "user-directory-unit.json";
+    directory.save(path);
+
+    UserDirectory loaded;
+    ASSERT_TRUE(loaded.load(path));
+    std::remove(path.c_str());
+    EXPECT_FALSE(loaded.load(path));
+    UserDirectory::Entry entry;
+    ASSERT_TRUE(loaded.find("bob brown", entry));
+    EXPECT_EQ(entry.account_id, "account-bob");
+    EXPECT_EQ(entry.display_name, "Bob Brown");
+    EXPECT_EQ(entry.resolved_at, 2000);
+    EXPECT_EQ(loaded.size(), 2u);
+}
+
+TEST(UserDirectory, SkipsMalformedEntries) {
+    std::string path = testing::TempDir() + "user-directory-malformed.json";
+    std::ofstream(path) << R"({"users": {)"
+        R"("smith": {"account_id": "account-smith", "display_name": "Alice Smith", "resolved_at": 1000},)"
+        R"("brown": {"account_id": 42, "display_name": "Bob Brown", "resolved_at": 2000},)"
+        R"("white": {"account_id": "account-white"},)"
+        R"("green": "account-green"}})";
+    UserDirectory directory;
+    EXPECT_TRUE(directory.load(path));
+    EXPECT_EQ(directory.size(), 1u);
+    UserDirectory::Entry entry;
+    EXPECT_TRUE(directory.find("smith", entry));
+    EXPECT_FALSE(directory.find("brown", entry));
+
+    std::ofstream(path, std::ios::trunc) << R"({"users": ["smith"]})";
+    EXPECT_FALSE(directory.load(path));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include "utils.hpp"
+
+TEST(Utils, ParseTimestampWithOffset) {
+    // 2020-05-27T10:45:12Z
+    EXPECT_EQ(Utils::parseTimestapm("2020-05-27T13:45:12.345+0300"), 1590576312);
+    EXPECT_EQ(Utils::parseTimestapm("2020-05-27T13:45:12+03:00"), 1590576312);
+    EXPECT_EQ(Utils::parseTimestapm("2020-05-27T10:45:12.000Z"), 1590576312);
+    EXPECT_EQ(Utils::parseTimestapm("2020-05-27T05:45:12-0500"), 1590576312);
+}
+
+TEST(Utils, ParseTimestampLocal) {
+    std::tm date = {};
+    date.tm_year = 120;
+    date.tm_mon = 4;
+    date.tm_mday = 27;
+    date.tm_isdst = -1;
+    time_t midnight = mktime(&date);
+    EXPECT_EQ(Utils::parseTimestapm("2020-05-27"), midnight);
+    EXPECT_EQ(Utils::parseTimestapm("2020-05-27T13:00:00"), midnight + 13 * 3600);
+}
+
+TEST(Utils, ParseTimestampIncorrect) {
+    EXPECT_EQ(Utils::parseTimestapm(""), (time_t)(-1));
+    EXPECT_EQ(Utils::parseTimestapm("27.05.2020"), (time_t)(-1));
+    EXPECT_EQ(Utils::parseTimestapm("2020-13-01"), (time_t)(-1));
+}
+
+TEST(Utils, TimeToString) {
+    time_t time = Utils::parseTimestapm("2020-05-27T13:45:12");
+    EXPECT_EQ(Utils::timeToString(time), "2020-05-27 13:45:12");
+    char buffer[26];
+    EXPECT_EQ(Utils::timeToString(time, buffer, sizeof(buffer)), 19u);
+    EXPECT_EQ(Utils::timeToString(time, buffer, 10), 0u);
+}